@@ -0,0 +1,234 @@
+/*************************************************************************************[BinaryCnf.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_BinaryCnf_h
+#define Minisat_BinaryCnf_h
+
+#include <stdio.h>
+#include <zlib.h>
+
+#include "minisat/utils/ParseUtils.h"
+#include "minisat/core/SolverTypes.h"
+#include "minisat/core/ClauseBatch.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Binary CNF format:
+//
+// A compact alternative to DIMACS that loads without any text parsing. All integers are little
+// endian; 'varint' is the usual base-128 encoding (low groups first, high bit = more follows).
+//
+//   header:   magic (8 bytes, see below), version (u32), flags (u32), variables (u32), clauses (u32)
+//   blocks:   payload size (u32), clauses in block (u32), payload, CRC-32 of payload (u32, only if
+//             flag 'bcnf_checksums' is set)
+//   end:      a block header with size 0 and 0 clauses
+//
+// A clause in a payload is 'varint(size)' followed by 'varint(zigzag(toInt(lit) - toInt(prev)))'
+// for every literal, where 'prev' starts out as 0 in each clause. Literal order is preserved, so
+// the solver sees exactly the clauses of the original file. No literal may refer to a variable
+// outside the header's variable count, and the header's variable count is the number of variables
+// reading the original DIMACS file creates (the highest variable used).
+
+static const unsigned char bcnf_magic[8] = { 0x89, 'B', 'C', 'N', 'F', '\r', '\n', 0x1a };
+enum { bcnf_version = 1, bcnf_checksums = 1, bcnf_header_size = 24, bcnf_block_size = 1 << 20 };
+
+static inline void putU32(vec<unsigned char>& out, uint32_t x) {
+    for (int i = 0; i < 4; i++) out.push((unsigned char)(x >> (8 * i))); }
+
+static inline uint32_t getU32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static inline void putVarint(vec<unsigned char>& out, uint32_t x) {
+    while (x >= 0x80){
+        out.push((unsigned char)(x | 0x80));
+        x >>= 7; }
+    out.push((unsigned char)x); }
+
+
+//-------------------------------------------------------------------------------------------------
+// Writer:
+
+
+class BinaryCnfWriter {
+    FILE*               f;
+    bool                checksums;
+    vec<unsigned char>  block;
+    uint32_t            block_clauses;
+
+    void write(vec<unsigned char>& data) {
+        if (data.size() > 0 && fwrite((unsigned char*)data, 1, data.size(), f) != (size_t)data.size())
+            fprintf(stderr, "ERROR! Could not write binary CNF.\n"), exit(1); }
+
+    void flushBlock() {
+        vec<unsigned char> head;
+        putU32(head, block.size());
+        putU32(head, block_clauses);
+        write(head);
+        write(block);
+        if (checksums && block.size() > 0){
+            vec<unsigned char> crc;
+            putU32(crc, (uint32_t)crc32(0, (const Bytef*)(unsigned char*)block, block.size()));
+            write(crc); }
+        block.clear();
+        block_clauses = 0; }
+
+    // Don't allow copying:
+    BinaryCnfWriter(const BinaryCnfWriter&);
+    BinaryCnfWriter& operator=(const BinaryCnfWriter&);
+
+public:
+    // Writes the header right away; 'vars' and 'clauses' must be the exact final counts:
+    BinaryCnfWriter(FILE* out, int vars, int clauses, bool crc = true) : f(out), checksums(crc), block_clauses(0) {
+        vec<unsigned char> head;
+        for (int i = 0; i < 8; i++) head.push(bcnf_magic[i]);
+        putU32(head, bcnf_version);
+        putU32(head, checksums ? bcnf_checksums : 0);
+        putU32(head, vars);
+        putU32(head, clauses);
+        write(head);
+        block.capacity(bcnf_block_size + 64); }
+
+    // Any clause type with 'size()' and 'operator[]':
+    template<class C>
+    void addClause(const C& c) {
+        putVarint(block, c.size());
+        int prev = 0;
+        for (int i = 0; i < c.size(); i++){
+            int d = toInt(c[i]) - prev;
+            putVarint(block, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+            prev = toInt(c[i]); }
+        block_clauses++;
+        if (block.size() >= bcnf_block_size) flushBlock(); }
+
+    // Flushes the last block and writes the end marker (the file itself is left open):
+    void finish() {
+        if (block_clauses > 0) flushBlock();
+        flushBlock(); }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Reader:
+
+
+// The first byte of the magic can not start a DIMACS file:
+static inline bool isBinaryCnf(int first_byte) { return first_byte == bcnf_magic[0]; }
+
+static inline uint32_t readVarint(const unsigned char*& p, const unsigned char* end) {
+    if (end - p >= 5){      // Unrolled, without bounds checks:
+        uint32_t v = p[0];
+        if (p[0] < 0x80){ p += 1; return v; }
+        v = (v & 0x7f)      | (uint32_t)p[1] << 7;
+        if (p[1] < 0x80){ p += 2; return v; }
+        v = (v & 0x3fff)    | (uint32_t)p[2] << 14;
+        if (p[2] < 0x80){ p += 3; return v; }
+        v = (v & 0x1fffff)  | (uint32_t)p[3] << 21;
+        if (p[3] < 0x80){ p += 4; return v; }
+        v = (v & 0xfffffff) | (uint32_t)p[4] << 28;
+        if (p[4] < 0x10){ p += 5; return v; }
+        printf("PARSE ERROR! Corrupt binary CNF block\n"), exit(3); }
+
+    uint32_t v = 0;
+    for (int shift = 0;; shift += 7){
+        if (p == end || shift > 28) printf("PARSE ERROR! Corrupt binary CNF block\n"), exit(3);
+        unsigned char b = *p++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (b < 0x80) return v; } }
+
+// The next 'n' bytes of input. Streams are copied into 'tmp'; mapped files are used in place:
+template<class B>
+static const unsigned char* takeBytes(B& in, uint32_t n, vec<unsigned char>& tmp) {
+    tmp.clear();
+    for (uint32_t i = 0; i < n; i++){
+        if (*in == EOF) return NULL;
+        tmp.push((unsigned char)*in);
+        ++in; }
+    return tmp; }
+
+static inline const unsigned char* takeBytes(MappedBuffer& in, uint32_t n, vec<unsigned char>&) {
+    if (in.remaining() < (size_t)n) return NULL;
+    const unsigned char* p = in.cur;
+    in.cur += n;
+    return p; }
+
+
+template<class B, class Solver>
+static void parse_BinaryCnf(B& in, Solver& S, bool strictp = false) {
+    vec<unsigned char> tmp;
+    const unsigned char* head = takeBytes(in, bcnf_header_size, tmp);
+    if (head == NULL || memcmp(head, bcnf_magic, 8) != 0)
+        printf("PARSE ERROR! Not a binary CNF file\n"), exit(3);
+    if (getU32(head + 8) != bcnf_version)
+        printf("PARSE ERROR! Unsupported binary CNF version %u\n", getU32(head + 8)), exit(3);
+    bool     checked = (getU32(head + 12) & bcnf_checksums) != 0;
+    uint32_t vars    = getU32(head + 16);
+    uint32_t clauses = getU32(head + 20);
+    if (vars > (uint32_t)INT32_MAX / 2)
+        printf("PARSE ERROR! Too many variables in binary CNF header\n"), exit(3);
+
+    S.reserveVars(vars);
+    const uint32_t max_lit = 2 * vars;
+
+    ClauseBatch batch(S.nVars() > (int)vars ? S.nVars() : (int)vars);
+    uint32_t    cnt  = 0;
+    bool        flag = false;
+    for (;;){
+        const unsigned char* bh = takeBytes(in, 8, tmp);
+        if (bh == NULL) printf("PARSE ERROR! Binary CNF is truncated\n"), exit(3);
+        uint32_t size = getU32(bh), block_clauses = getU32(bh + 4);
+        if (size == 0 && block_clauses == 0) break;
+        // Every clause takes at least one byte, and a block must fit in a 'vec':
+        if (size > (uint32_t)INT32_MAX || block_clauses > size)
+            printf("PARSE ERROR! Corrupt binary CNF block header\n"), exit(3);
+
+        const unsigned char* p = takeBytes(in, size, tmp);
+        if (p == NULL) printf("PARSE ERROR! Binary CNF is truncated\n"), exit(3);
+        if (checked){
+            uint32_t crc = (uint32_t)crc32(0, p, size);
+            vec<unsigned char> ctmp;
+            const unsigned char* c = takeBytes(in, 4, ctmp);
+            if (c == NULL || getU32(c) != crc)
+                printf("PARSE ERROR! Binary CNF checksum mismatch in block %u\n", cnt), exit(3); }
+
+        const unsigned char* end = p + size;
+        for (uint32_t k = 0; k < block_clauses; k++){
+            uint32_t n    = readVarint(p, end);
+            int      prev = 0;
+            for (uint32_t i = 0; i < n; i++){
+                uint32_t v = readVarint(p, end);
+                int      l = prev + (int)((v >> 1) ^ (0u - (v & 1)));
+                if ((uint32_t)l >= max_lit) printf("PARSE ERROR! Literal out of range in binary CNF\n"), exit(3);
+                batch.lits.push(toLit(l));
+                prev = l; }
+            batch.endClause();
+            cnt++;
+        }
+        if (p != end) printf("PARSE ERROR! Corrupt binary CNF block\n"), exit(3);
+        if (batch.full())
+            flushBatch(S, batch, flag);
+    }
+    flushBatch(S, batch, flag);
+
+    if (strictp && cnt != clauses)
+        printf("PARSE ERROR! Binary CNF header mismatch: wrong number of clauses\n");
+}
+
+//=================================================================================================
+}
+
+#endif
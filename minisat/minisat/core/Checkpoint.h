@@ -0,0 +1,189 @@
+/************************************************************************************[Checkpoint.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_Checkpoint_h
+#define Minisat_Checkpoint_h
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "minisat/mtl/Vec.h"
+#include "minisat/mtl/IntMap.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Solver checkpoints:
+//
+// A checkpoint is a memory image of the solver state: the header below, then one section per class
+// in the solver's hierarchy, each starting with a 4-byte tag (see 'Solver::saveState()'). Everything
+// is written in native byte order and layout, so a checkpoint can only be resumed by the same build
+// on the same kind of machine; the header catches accidental mismatches.
+//
+//   header:   magic (8 bytes), version (u32), byte order probe 0x01020304 (u32), size of a
+//             pointer (u32)
+//   vectors:  number of elements (int), then the elements
+//   end:      CRC-32 of everything before it (u32)
+//
+// The clause arena is written as one vector, i.e. with a single call to 'fwrite()'. The checksum is
+// verified before anything is restored; the solver still range-checks what it reads, as a file
+// from a buggy or foreign build can carry a valid checksum.
+
+static const unsigned char checkpoint_magic[8] = { 0x89, 'M', 'S', 'C', 'K', '\r', '\n', 0x1a };
+enum { checkpoint_version = 4 };
+
+// 'crc32()' takes at most 4 GB at a time (and restarts on a null pointer, as for an empty vector):
+static inline uLong checkpointCrc(uLong crc, const void* data, size_t bytes) {
+    if (bytes == 0) return crc;
+    const Bytef* p = (const Bytef*)data;
+    for (; bytes > (1u << 30); p += 1u << 30, bytes -= 1u << 30)
+        crc = crc32(crc, p, 1u << 30);
+    return crc32(crc, p, (uInt)bytes); }
+
+
+class CheckpointWriter {
+    FILE* out;
+    bool  ok;
+    uLong crc;      // Of everything written so far.
+
+ public:
+    explicit CheckpointWriter(FILE* f) : out(f), ok(true), crc(crc32(0L, Z_NULL, 0)) {}
+
+    bool okay  () const { return ok; }
+    void write (const void* data, size_t bytes) {
+        if (ok && bytes > 0 && fwrite(data, 1, bytes, out) != bytes) ok = false;
+        crc = checkpointCrc(crc, data, bytes); }
+
+    void putTag(const char* tag) { write(tag, 4); }
+
+    template<class T>
+    void put   (const T& x) { write(&x, sizeof(T)); }
+
+    template<class T>
+    void putVec(const T* data, int n) { put(n); write(data, sizeof(T) * (size_t)n); }
+
+    template<class T>
+    void putVec(const vec<T>& v) { putVec(v.getdata(), v.size()); }
+
+    template<class K, class V, class I>
+    void putMap(const IntMap<K,V,I>& m) { putVec(m.begin(), (int)(m.end() - m.begin())); }
+
+    void putHeader() {
+        write(checkpoint_magic, sizeof(checkpoint_magic));
+        put((uint32_t)checkpoint_version);
+        put((uint32_t)0x01020304);
+        put((uint32_t)sizeof(void*)); }
+
+    // Must come last:
+    void putChecksum() { put((uint32_t)crc); }
+};
+
+
+class CheckpointReader {
+    FILE*  in;
+    bool   ok;
+    size_t left;    // Bytes before the checksum not yet read (known after 'verify()').
+
+ public:
+    explicit CheckpointReader(FILE* f) : in(f), ok(true), left(SIZE_MAX) {}
+
+    bool okay  () const { return ok; }
+    void fail  ()       { ok = false; }
+    bool atEnd ()       { return ok && fgetc(in) == EOF; }
+
+    void read  (void* data, size_t bytes) {
+        if (ok && bytes > 0 && fread(data, 1, bytes, in) != bytes) ok = false;
+        left -= bytes < left ? bytes : left; }
+
+    // Whether 'n' elements of size 'size' can still follow, so a corrupt count fails here rather
+    // than in a huge allocation:
+    bool fits  (size_t n, size_t size) { if (n > left / size) ok = false; return ok; }
+
+    // Checks the trailing CRC-32 against the rest of the file, from the start, and rewinds:
+    bool verify() {
+        if (fseeko(in, 0, SEEK_END) != 0) return ok = false;
+        off_t size = ftello(in);
+        rewind(in);
+        if (size < 4) return ok = false;
+
+        uLong         crc  = crc32(0L, Z_NULL, 0);
+        unsigned char buf[1 << 16];
+        for (off_t rest = size - 4; rest > 0 && ok;){
+            size_t n = rest < (off_t)sizeof(buf) ? (size_t)rest : sizeof(buf);
+            read(buf, n);
+            crc   = checkpointCrc(crc, buf, n);
+            rest -= n; }
+        uint32_t stored = 0;
+        get(stored);
+        if (ok && stored != (uint32_t)crc) ok = false;
+        rewind(in);
+        left = (size_t)(size - 4);
+        return ok; }
+
+    // Skips the checksum at the end (see 'verify()'):
+    void getChecksum() { uint32_t c; get(c); }
+
+    void getTag(const char* tag) {
+        char b[4];
+        read(b, 4);
+        if (ok && memcmp(b, tag, 4) != 0) ok = false; }
+
+    template<class T>
+    void get   (T& x) { read(&x, sizeof(T)); }
+
+    // Reads the element count of a vector and checks it against 'expected' (if not negative):
+    int  getSize(int expected = -1) {
+        int n = -1;
+        get(n);
+        if (n < 0 || (expected >= 0 && n != expected)) ok = false;
+        return ok ? n : 0; }
+
+    // Into a vector of the right size ('vec' or anything with 'clear()', 'growTo()' and a conversion
+    // to 'T*'); 'pad' is only needed for elements without default constructor:
+    template<class V, class T>
+    void getVec(V& v, const T& pad) {
+        int n = getSize();
+        if (!fits(n, sizeof(T))) return;
+        v.clear();
+        v.growTo(n, pad);
+        read((T*)v, sizeof(T) * (size_t)n); }
+
+    template<class T>
+    void getVec(vec<T>& v) { getVec(v, T()); }
+
+    // The map must already have the same number of entries as the saved one:
+    template<class K, class V, class I>
+    void getMap(IntMap<K,V,I>& m) {
+        int n = getSize((int)(m.end() - m.begin()));
+        read(m.begin(), sizeof(V) * (size_t)n); }
+
+    bool getHeader() {
+        unsigned char magic[sizeof(checkpoint_magic)];
+        uint32_t      version = 0, order = 0, ptr = 0;
+        read(magic, sizeof(magic));
+        get(version); get(order); get(ptr);
+        if (!ok || memcmp(magic, checkpoint_magic, sizeof(magic)) != 0 || version != checkpoint_version
+            || order != 0x01020304 || ptr != sizeof(void*))
+            ok = false;
+        return ok; }
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,72 @@
+/***********************************************************************************[ClauseBatch.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_ClauseBatch_h
+#define Minisat_ClauseBatch_h
+
+#include "minisat/mtl/Vec.h"
+#include "minisat/core/SolverTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Clauses on their way from a reader to 'addClauses()':
+//
+// The readers collect clauses in flat form and hand them over in large batches. While reading, the
+// batch also stands in for the solver ('nVars()'/'newVar()'), so variables are only counted, and
+// created in one go when the batch is handed over.
+
+struct ClauseBatch {
+    vec<Lit> lits;
+    vec<int> offsets;       // Clause 'i' is 'lits[offsets[i]] .. lits[offsets[i+1]-1]'.
+    int      vars;
+
+    enum { min_lits = 1 << 20 };
+
+    explicit ClauseBatch(int v = 0) : vars(v) { offsets.push(0); }
+
+    int  nVars    () const { return vars; }
+    Var  newVar   ()       { return vars++; }
+    int  clauses  () const { return offsets.size() - 1; }
+    void endClause()       { offsets.push(lits.size()); }
+    void clear    ()       { lits.clear(); offsets.clear(); offsets.push(0); }
+
+    // 'addClauses()' does work proportional to the number of variables, so don't hand over less:
+    bool full     () const { return lits.size() >= min_lits && lits.size() >= 2 * vars; }
+};
+
+
+// Creates the batch's variables, adds its clauses and empties it. The first clause of the whole
+// input is also passed to 'bindFirstClauseVariables()' ('first_seen' tracks this across batches):
+template<class Solver>
+static void flushBatch(Solver& S, ClauseBatch& b, bool& first_seen) {
+    while (S.nVars() < b.vars) S.newVar();
+    if (!first_seen && b.clauses() > 0){
+        vec<Lit> first;
+        for (int k = b.offsets[0]; k < b.offsets[1]; k++)
+            first.push(b.lits[k]);
+        S.bindFirstClauseVariables(first);
+        first_seen = true;
+    }
+    S.addClauses(b.lits, b.offsets);
+    b.clear();
+}
+
+//=================================================================================================
+}
+
+#endif
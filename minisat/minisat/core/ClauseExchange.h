@@ -0,0 +1,136 @@
+/********************************************************************************[ClauseExchange.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_ClauseExchange_h
+#define Minisat_ClauseExchange_h
+
+#include <assert.h>
+#include <atomic>
+#include <new>
+
+#include "minisat/mtl/Vec.h"
+#include "minisat/mtl/XAlloc.h"
+#include "minisat/core/SolverTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Learnt clause exchange between solvers working on the same formula (same variable numbering):
+//
+// Every participant owns a broadcast ring of fixed-size slots that only it writes. Peers read each
+// ring at their own pace and never block the writer: a reader that falls more than a ring behind
+// loses the overwritten clauses, and a slot that is overwritten while being read is detected
+// (seqlock style, through 'reserve') and skipped. Which clauses are worth sharing is decided by
+// the exporting solver, using 'max_size' and 'max_lbd' (units and binaries are always shared).
+
+class ClauseExchange {
+public:
+    enum { Max_Size = 31 };             // Longest clause that fits in a slot.
+
+private:
+    enum { Cache_Line = 64, Slot_Words = Max_Size + 1 };
+
+    struct Ring {
+        alignas(Cache_Line) std::atomic<uint64_t> head;     // Slots published so far.
+        std::atomic<uint64_t>                     reserve;  // Slots written (or being written) so far.
+        std::atomic<uint32_t>*                    words;    // Slot: size | lbd << 8, then the literals.
+    };
+
+    Ring*     rings;
+    uint64_t* cursors;                  // cursors[to * n + from]: next slot of 'from' for reader 'to'.
+    int       n;
+    uint32_t  slot_mask;
+
+    // Don't allow copying:
+    ClauseExchange(const ClauseExchange&);
+    ClauseExchange& operator=(const ClauseExchange&);
+
+public:
+    int       max_size;                 // Share clauses up to this size ...
+    int       max_lbd;                  // ... whose LBD is at most this.
+
+    // Slots per ring are rounded up to the next power of two:
+    ClauseExchange(int participants, uint32_t min_slots = 4096) : n(participants), max_size(8), max_lbd(3) {
+        uint32_t slots = 2;
+        while (slots < min_slots) slots <<= 1;
+        slot_mask = slots - 1;
+        rings   = (Ring*)xrealloc(NULL, sizeof(Ring) * n);
+        cursors = (uint64_t*)xrealloc(NULL, sizeof(uint64_t) * n * n);
+        for (int i = 0; i < n; i++){
+            new (&rings[i].head)    std::atomic<uint64_t>(0);
+            new (&rings[i].reserve) std::atomic<uint64_t>(0);
+            rings[i].words = (std::atomic<uint32_t>*)xrealloc(NULL, sizeof(std::atomic<uint32_t>) * slots * Slot_Words);
+            for (uint32_t k = 0; k < slots * Slot_Words; k++) new (&rings[i].words[k]) std::atomic<uint32_t>(0); }
+        for (int i = 0; i < n * n; i++) cursors[i] = 0; }
+
+   ~ClauseExchange() {
+        for (int i = 0; i < n; i++) free(rings[i].words);
+        free(rings);
+        free(cursors); }
+
+    int  participants() const { return n; }
+
+    // Writer side, only ever called by participant 'from':
+    void publish(int from, const vec<Lit>& c, int lbd) {
+        assert(c.size() <= Max_Size);
+        Ring&    r = rings[from];
+        uint64_t h = r.head.load(std::memory_order_relaxed);
+        r.reserve.store(h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::atomic<uint32_t>* slot = &r.words[(h & slot_mask) * Slot_Words];
+        slot[0].store((uint32_t)c.size() | ((uint32_t)(lbd < 255 ? lbd : 255) << 8), std::memory_order_relaxed);
+        for (int i = 0; i < c.size(); i++)
+            slot[i + 1].store((uint32_t)toInt(c[i]), std::memory_order_relaxed);
+        r.head.store(h + 1, std::memory_order_release); }
+
+    // Reader side, only ever called by participant 'to'. Passes every clause the other participants
+    // published since the previous call to 'f(vec<Lit>& c, int lbd)' (which may modify 'c'). Returns
+    // the number of clauses that were lost because the reader fell behind:
+    template<class F>
+    uint64_t collect(int to, vec<Lit>& c, F f) {
+        uint64_t lost = 0;
+        for (int from = 0; from < n; from++){
+            if (from == to) continue;
+            Ring&     r   = rings[from];
+            uint64_t& cur = cursors[to * n + from];
+            uint64_t  h   = r.head.load(std::memory_order_acquire);
+            if (h - cur > slot_mask + 1){
+                lost += h - cur - (slot_mask + 1);
+                cur   = h - (slot_mask + 1); }
+
+            for (; cur < h; cur++){
+                std::atomic<uint32_t>* slot = &r.words[(cur & slot_mask) * Slot_Words];
+                uint32_t hdr  = slot[0].load(std::memory_order_relaxed);
+                int      size = hdr & 0xff;
+                c.clear();
+                for (int i = 0; i < size && i < Max_Size; i++)
+                    c.push(toLit((int)slot[i + 1].load(std::memory_order_relaxed)));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (r.reserve.load(std::memory_order_relaxed) > cur + slot_mask + 1){
+                    lost++;             // Overwritten while being read.
+                    continue; }
+                f(c, (int)(hdr >> 8));
+            }
+        }
+        return lost; }
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -22,19 +22,29 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Minisat_Dimacs_h
 
 #include <stdio.h>
+#include <thread>
+#include <vector>
 
 #include "minisat/utils/ParseUtils.h"
+#include "minisat/utils/OutputBuffer.h"
 #include "minisat/core/SolverTypes.h"
+#include "minisat/core/ClauseBatch.h"
+#include "minisat/core/BinaryCnf.h"
 
 namespace Minisat {
 
 //=================================================================================================
 // DIMACS Parser:
+//
+// Clauses are collected in a 'ClauseBatch' and handed to the solver with 'addClauses()' in large
+// batches. The solver also needs 'reserveVars()', which is called with the header's variable count
+// (see 'reserveBound()').
 
+
+// Appends the literals of the next clause to 'lits':
 template<class B, class Solver>
 static void readClause(B& in, Solver& S, vec<Lit>& lits) {
     int     parsed_lit, var;
-    lits.clear();
     for (;;){
         parsed_lit = parseInt(in);
         if (parsed_lit == 0) break;
@@ -44,9 +54,52 @@ static void readClause(B& in, Solver& S, vec<Lit>& lits) {
     }
 }
 
+// Same for a memory-mapped file. Keeps the position in a local pointer and scans with the SWAR
+// digit parser; only the last few bytes of the file go through the generic 'parseInt()':
+template<class Solver>
+static void readClause(MappedBuffer& in, Solver& S, vec<Lit>& lits) {
+    const unsigned char* p   = in.cur;
+    const unsigned char* end = p + in.remaining();
+    for (;;){
+        while (p < end && (*p == ' ' || (*p >= 9 && *p <= 13))) p++;
+        int parsed_lit;
+        if (end - p >= 9)
+            parsed_lit = parseIntSwar(p, end);
+        else{
+            in.cur = p;
+            parsed_lit = parseInt(in);
+            p = in.cur;
+        }
+        if (parsed_lit == 0) break;
+        int var = abs(parsed_lit)-1;
+        while (var >= S.nVars()) S.newVar();
+        lits.push( (parsed_lit > 0) ? mkLit(var) : ~mkLit(var) );
+    }
+    in.cur = p;
+}
+
+// The header counts are only hints for pre-allocation. The reservation is capped by what the rest of
+// the input can mention (every variable takes at least two bytes), or by a fixed amount if the size
+// of the input is unknown, so that a bogus header cannot exhaust memory:
+enum { dimacs_stream_reserve = 1 << 17 };
+
+static inline int reserveBound(StreamBuffer&, int vars) { return vars < dimacs_stream_reserve ? vars : dimacs_stream_reserve; }
+static inline int reserveBound(MappedBuffer& in, int vars) {
+    return (size_t)vars <= in.remaining() / 2 ? vars : (int)(in.remaining() / 2); }
+
+template<class B, class Solver>
+static void parseHeader(B& in, Solver& S, int& vars, int& clauses) {
+    vars    = parseInt(in);
+    clauses = parseInt(in);
+    if (vars > INT32_MAX / 2)
+        printf("PARSE ERROR! Too many variables in DIMACS header\n"), exit(3);
+    S.reserveVars(reserveBound(in, vars));
+}
+
+
 template<class B, class Solver>
 static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false) {
-    vec<Lit> lits;
+    ClauseBatch batch(S.nVars());
     int vars    = 0;
     int clauses = 0;
     int cnt     = 0;
@@ -55,23 +108,20 @@ static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false) {
         skipWhitespace(in);
         if (*in == EOF) break;
         else if (*in == 'p'){
-            if (eagerMatch(in, "p cnf")){
-                vars    = parseInt(in);
-                clauses = parseInt(in);
-            }
+            if (eagerMatch(in, "p cnf"))
+                parseHeader(in, S, vars, clauses);
             else printf("PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
         } 
         else if (*in == 'c' || *in == 'p') skipLine(in);
         else{
             cnt++;
-            readClause(in, S, lits);
-            if (!flag){
-                S.bindFirstClauseVariables(lits);
-                flag = true;
-            }
-            S.addClause_(lits); 
+            readClause(in, batch, batch.lits);
+            batch.endClause();
+            if (batch.full())
+                flushBatch(S, batch, flag);
         }
     }
+    flushBatch(S, batch, flag);
     if (strictp && cnt != clauses)
         printf("PARSE ERROR! DIMACS header mismatch: wrong number of clauses\n");
 }
@@ -80,8 +130,153 @@ static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false) {
 template<class Solver>
 static void parse_DIMACS(gzFile input_stream, Solver& S, bool strictp = false) {
     StreamBuffer in(input_stream);
-    parse_DIMACS_main(in, S, strictp); 
+    if (isBinaryCnf(*in))
+        parse_BinaryCnf(in, S, strictp);
+    else
+        parse_DIMACS_main(in, S, strictp); 
+}
+
+//=================================================================================================
+// Multi-threaded parsing of memory-mapped input:
+//
+// The clause section is cut into chunks at line ends that terminate a clause, the chunks are parsed
+// concurrently into one batch each, and the batches are then added to the solver in file order, so
+// the result is identical to the sequential parser's.
+
+enum { dimacs_min_chunk = 1 << 20 };    // Smaller chunks are not worth a thread.
+
+
+// First position at or after 'p' that starts a line and follows a line ending with a '0' token
+// (or 'end' if there is none):
+static inline const unsigned char* clauseBoundary(const unsigned char* beg, const unsigned char* p, const unsigned char* end) {
+    while (p < end){
+        const unsigned char* nl = (const unsigned char*)memchr(p, '\n', end - p);
+        if (nl == NULL) return end;
+        const unsigned char* q = nl;
+        while (q > beg && (q[-1] == ' ' || q[-1] == '\t' || q[-1] == '\r')) q--;
+        if (q > beg && q[-1] == '0' && (q - 1 == beg || q[-2] == ' ' || q[-2] == '\t' || q[-2] == '\n'))
+            return nl + 1;
+        p = nl + 1;
+    }
+    return end;
+}
+
+
+static void parseChunk(MappedBuffer& in, ClauseBatch& chunk, int est_clauses, int est_lits) {
+    chunk.offsets.capacity(est_clauses + 1);
+    chunk.lits   .capacity(est_lits);
+    for (;;){
+        skipWhitespace(in);
+        if (*in == EOF) break;
+        else if (*in == 'c' || *in == 'p') skipLine(in);
+        else{
+            readClause(in, chunk, chunk.lits);
+            chunk.endClause();
+        }
+    }
 }
+
+
+// Parses with up to 'threads' threads if the input is large enough, sequentially otherwise. Binary
+// CNF input is recognized and read directly:
+template<class Solver>
+static void parse_DIMACS(MappedBuffer& in, Solver& S, bool strictp = false, int threads = 1) {
+    if (isBinaryCnf(*in)){
+        parse_BinaryCnf(in, S, strictp);
+        return; }
+    if (threads > (int)(in.remaining() / dimacs_min_chunk)) threads = (int)(in.remaining() / dimacs_min_chunk);
+    if (threads <= 1){
+        parse_DIMACS_main(in, S, strictp);
+        return; }
+
+    // Header (and leading comments):
+    int vars    = 0;
+    int clauses = 0;
+    for (;;){
+        skipWhitespace(in);
+        if (*in == 'c') skipLine(in);
+        else if (*in == 'p'){
+            if (eagerMatch(in, "p cnf"))
+                parseHeader(in, S, vars, clauses);
+            else printf("PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+        }
+        else break;
+    }
+
+    // Split and parse. Buffers are pre-sized from the header, assuming an even spread of clauses:
+    const unsigned char* beg = in.cur;
+    const unsigned char* end = beg + in.remaining();
+    vec<const unsigned char*> bounds;
+    bounds.push(beg);
+    for (int i = 1; i < threads; i++){
+        const unsigned char* b = clauseBoundary(beg, beg + (end - beg) / threads * i, end);
+        if (b > bounds.last() && b < end) bounds.push(b); }
+    bounds.push(end);
+
+    int digits = 1;
+    for (int v = vars; v >= 10; v /= 10) digits++;
+    int n = bounds.size() - 1;
+    ClauseBatch* chunks = new ClauseBatch[n];
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; i++){
+        double share = (double)(bounds[i+1] - bounds[i]) / (end - beg);
+        double est         = clauses * share * 1.1;
+        int    est_clauses = (int)(est < (bounds[i+1] - bounds[i]) / 2.0 ? est : (bounds[i+1] - bounds[i]) / 2.0) + 16;
+        int    est_lits    = (int)((bounds[i+1] - bounds[i]) / (digits + 1.5));
+        workers.push_back(std::thread([&, i, est_clauses, est_lits]{
+            MappedBuffer view(bounds[i], bounds[i+1]);
+            parseChunk(view, chunks[i], est_clauses, est_lits); }));
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    in.cur = end;
+
+    // Add everything in file order:
+    int  cnt  = 0;
+    bool flag = false;
+    for (int i = 0; i < n; i++){
+        cnt += chunks[i].clauses();
+        flushBatch(S, chunks[i], flag);
+        chunks[i].lits   .clear(true);
+        chunks[i].offsets.clear(true);
+    }
+    delete [] chunks;
+
+    if (strictp && cnt != clauses)
+        printf("PARSE ERROR! DIMACS header mismatch: wrong number of clauses\n");
+}
+
+// Maps 'path' if it is uncompressed, and reads it through zlib otherwise. Returns FALSE if the file
+// could not be opened.
+template<class Solver>
+static bool parse_DIMACS(const char* path, Solver& S, bool strictp = false, int threads = 1) {
+    MappedBuffer mapped;
+    if (mapped.open(path)){
+        parse_DIMACS(mapped, S, strictp, threads);
+        return true; }
+
+    gzFile in = gzopen(path, "rb");
+    if (in == NULL) return false;
+    parse_DIMACS(in, S, strictp);
+    gzclose(in);
+    return true;
+}
+
+//=================================================================================================
+// Model output:
+
+
+// The assigned variables of 'model' as literals on one line, terminated by " 0":
+static inline void printModel(FILE* f, const vec<lbool>& model) {
+    OutputBuffer out(f);
+    for (int i = 0; i < model.size(); i++)
+        if (model[i] != l_Undef){
+            if (i != 0) out.put(' ');
+            out.putInt(model[i] == l_True ? i+1 : -(i+1)); }
+    out.put(" 0\n");
+}
+
+//=================================================================================================
 }
 
 #endif
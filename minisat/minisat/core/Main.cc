@@ -36,6 +36,7 @@ using namespace Minisat;
 
 static Solver* solver;
 static void SIGINT_interrupt(int) { solver->interrupt(); }
+static void SIGUSR1_checkpoint(int) { solver->requestCheckpoint(); }
 
 // Note that '_exit()' rather than 'exit()' has to be used. The reason is that 'exit()' calls
 // destructors and may cause deadlocks if a malloc/free function happens to be running (these
@@ -65,6 +66,10 @@ int main(int argc, char** argv){
         IntOption    cpu_lim("MAIN", "cpu-lim","Limit on CPU time allowed in seconds.\n", 0, IntRange(0, INT32_MAX));
         IntOption    mem_lim("MAIN", "mem-lim","Limit on memory usage in megabytes.\n", 0, IntRange(0, INT32_MAX));
         BoolOption   strictp("MAIN", "strict", "Validate DIMACS header during parsing.", false);
+        IntOption    threads("MAIN", "parse-threads", "Threads for parsing uncompressed (memory-mapped) input.", 1, IntRange(1, 256));
+        StringOption checkpt("MAIN", "checkpoint", "Save the search state to this file periodically and when sent SIGUSR1.");
+        IntOption    ckpt_iv("MAIN", "checkpoint-interval", "Seconds between checkpoints (0 = only on SIGUSR1).\n", 600, IntRange(0, INT32_MAX));
+        StringOption resume ("MAIN", "resume", "Continue the search saved in this checkpoint (the input file is not read).");
         parseOptions(argc, argv, true);
         FILE* res = (argc >= 3) ? fopen(argv[2], "wb") : stdout;
         Solver S = Solver();
@@ -75,18 +80,26 @@ int main(int argc, char** argv){
         sigTerm(SIGINT_exit);
         if (cpu_lim != 0) limitTime(cpu_lim);
         if (mem_lim != 0) limitMemory(mem_lim);
-        if (argc == 1) printf("Reading from standard input... Use '--help' for help.\n");
-        gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
+        if (argc == 1 && !resume) printf("Reading from standard input... Use '--help' for help.\n");
+        MappedBuffer mapped;    // Uncompressed files are memory-mapped instead of read through zlib.
+        gzFile in = resume ? NULL : (argc == 1) ? gzdopen(0, "rb") : mapped.open(argv[1]) ? NULL : gzopen(argv[1], "rb");
 
-        if (in == NULL) printf("ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
+        if (!resume && in == NULL && !mapped.isOpen()) printf("ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
         
         if (S.verbosity > 0){
             printf("============================[ Problem Statistics ]=============================\n");
             printf("|                                                                             |\n");
         }
         
-        parse_DIMACS(in, S, (bool)strictp);
-        gzclose(in);
+        if (resume){
+            if (!S.readCheckpoint(resume))
+                printf("ERROR! Could not resume from checkpoint: %s\n", (const char*)resume), exit(1); }
+        else if (mapped.isOpen()){
+            parse_DIMACS(mapped, S, (bool)strictp, threads);
+            mapped.close(); }
+        else{
+            parse_DIMACS(in, S, (bool)strictp);
+            gzclose(in); }
         
         if (S.verbosity > 0){
             printf("|  Number of variables:  %12d                                         |\n", S.nVars());
@@ -101,8 +114,12 @@ int main(int argc, char** argv){
         }
  
         sigTerm(SIGINT_interrupt);
+        if (checkpt){
+            S.checkpoint_file     = checkpt;
+            S.checkpoint_interval = ckpt_iv;
+            sigCheckpoint(SIGUSR1_checkpoint); }
        
-        if (!S.simplify()){
+        if (!resume && !S.simplify()){
             if (res != NULL) fprintf(res, "UNSAT\n"), fclose(res);
             if (S.verbosity > 0){
                 printf("===============================================================================\n");
@@ -128,10 +145,7 @@ int main(int argc, char** argv){
         if (res != NULL){
             if (ret == l_True){
                 fprintf(res, "SAT\n");
-                for (int i = 0; i < S.nVars(); i++)
-                    if (S.model[i] != l_Undef)
-                        fprintf(res, "%s%s%d", (i==0)?"":" ", (S.model[i]==l_True)?"":"-", i+1);
-                fprintf(res, " 0\n");
+                printModel(res, S.model);
             }else if (ret == l_False)
                 fprintf(res, "UNSAT\n");
             else
@@ -19,12 +19,19 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 **************************************************************************************************/
 
 #include <math.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 #include <bits/stdc++.h>
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/Sort.h"
 #include "minisat/utils/System.h"
+#include "minisat/utils/OutputBuffer.h"
 #include "minisat/core/Solver.h"
-#include <semaphore.h>
+#include "minisat/core/ClauseExchange.h"
+#include "minisat/core/BinaryCnf.h"
+#include "minisat/core/Checkpoint.h"
 #include <chrono>
 
 using namespace Minisat;
@@ -59,6 +66,13 @@ Solver::Solver():
     verbosity        (0)
   , var_decay        (opt_var_decay)
   , iter(0)
+  , vizFlag            (false)
+  , trackClauseVarRatio(false)
+  , sampleConflicts    (0)
+  , sampleRestarts     (true)
+  , sampleReduceDB     (false)
+  , activityTopK       (10)
+  , conflictStatsAlpha (1.0 / 32)
   , clause_decay     (opt_clause_decay)
   , random_var_freq  (opt_random_var_freq)
   , random_seed      (opt_random_seed)
@@ -69,6 +83,8 @@ Solver::Solver():
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
   , min_learnts_lim  (opt_min_learnts_lim)
+  , checkpoint_file  (NULL)
+  , checkpoint_interval(0)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
   , inter(0)
@@ -77,7 +93,15 @@ Solver::Solver():
   , learntsize_adjust_inc         (1.5)
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
   , dec_vars(0), num_clauses(0), num_learnts(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
+  , curr_restarts      (0)
+  , shared_exported    (0)
+  , shared_imported    (0)
+  , shared_useful      (0)
+  , shared_lost        (0)
   , watches            (WatcherDeleted(ca))
+  , watches_bin        (WatcherDeleted(ca))
+  , logFile            (NULL)
+  , outputFile         (NULL)
   , order_heap         (VarOrderLt(activity))
   , ok                 (true)
   , cla_inc            (1)
@@ -88,18 +112,30 @@ Solver::Solver():
   , progress_estimate  (0)
   , remove_satisfied   (true)
   , next_var           (0)
+  , lbd_counter        (0)
+  , samples            (1024)
+  , vizStartTime       (0)
+  , clause_var_ratio   (0)
+  , ema_lbd            (0)
+  , ema_backjump       (0)
+  , ema_conflict_level (0)
+  , avg_topk_activity  (0)
+  , exchange           (NULL)
+  , exchange_id        (0)
   , conflict_budget    (-1)
   , propagation_budget (-1)
+  , cpu_budget         (-1)
+  , mem_budget         (0)
+  , next_resource_check(UINT64_MAX)
   , asynch_interrupt   (false)
+  , checkpoint_requested(0)
+  , next_checkpoint    (0)
+  , solving            (false)
+  , resuming           (false)
   , sumPercentage      (0)
   , averageActivity    (0)
   , gcEvents           (0)
-  , curr_restarts      (0)
-{ 
-    sem_init(&propagationDone,false,0);
-    sem_init(&calculationDone,false,1);
-    waitingThreads = 0;
-}
+{}
 
 Solver::Solver(string& logFile,string& outputFile):Solver(){
     this->logFile = fopen(logFile.c_str(),"wb");
@@ -139,7 +175,12 @@ Var Solver::newVar(lbool upol, bool dvar){
     else v = next_var++;
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    watches_bin.init(mkLit(v, false));
+    watches_bin.init(mkLit(v, true ));
     assigns  .insert(v, l_Undef);
+    lit_value.insert(mkLit(v, false), 0, 0);
+    lit_value.insert(mkLit(v, true ), 0, 0);
+    lit_value.capacity(mkLit(v + 2, false));    // Slack for the AVX2 scan in 'propagate()'.
     vardata  .insert(v, mkVarData(CRef_Undef, 0));
     activity .insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
     seen     .insert(v, 0);
@@ -189,43 +230,118 @@ bool Solver::addClause_(vec<Lit>& ps){
 }
 
 
+// Pre-allocates the per-variable data for 'n' variables in total, so that creating them one by one
+// with 'newVar()' does not reallocate over and over:
+void Solver::reserveVars(int n){
+    if (n <= nVars()) return;
+    Var v = n - 1;
+    watches .capacity(mkLit(v, true));
+    watches_bin.capacity(mkLit(v, true));
+    assigns .capacity(v);
+    lit_value.capacity(mkLit(v + 2, false));
+    vardata .capacity(v);
+    activity.capacity(v);
+    seen    .capacity(v);
+    polarity.capacity(v);
+    user_pol.capacity(v);
+    decision.capacity(v);
+    trail   .capacity(n);
+}
+
+
+// Adds the clauses 'lits[offsets[i]] .. lits[offsets[i+1]-1]' for 'i = 0 .. offsets.size()-2', with
+// the same result as calling 'addClause_()' on each of them in turn. The assignment-independent
+// normalization (sorting, duplicates, tautologies) is done for the whole batch first, in place,
+// which also tells how much to reserve in the clause arena and the watch lists. Variables must
+// exist already. The counting touches every literal of the solver, so batches should be large.
+bool Solver::addClauses(vec<Lit>& lits, const vec<int>& offsets){
+    assert(decisionLevel() == 0);
+    if (!ok) return false;
+    int n = offsets.size() - 1;
+    if (n <= 0) return true;
+
+    vec<int> sizes(n);          // Size after normalization; -1 for tautologies.
+    vec<int> watch_cnt(2 * nVars(), 0);
+    vec<int> bin_cnt  (2 * nVars(), 0);
+    int      kept = 0, kept_lits = 0;
+    for (int i = 0; i < n; i++){
+        Lit* c  = (Lit*)lits + offsets[i];
+        int  sz = offsets[i+1] - offsets[i];
+        sort(c, sz);
+        Lit p = lit_Undef;
+        int j = 0;
+        for (int k = 0; k < sz; k++)
+            if (c[k] == ~p){ j = -1; break; }
+            else if (c[k] != p) c[j++] = p = c[k];
+        sizes[i] = j;
+        if (j >= 2){
+            assert(var(c[j-1]) < nVars());
+            kept++, kept_lits += j;
+            vec<int>& cnt = j == 2 ? bin_cnt : watch_cnt;
+            cnt[toInt(~c[0])]++;
+            cnt[toInt(~c[1])]++; }
+    }
+
+    ca.reserve(kept, kept_lits);
+    clauses.capacity(clauses.size() + kept);
+    for (int i = 0; i < watch_cnt.size(); i++){
+        if (watch_cnt[i] > 0){
+            WatchList& ws = watches[toLit(i)];
+            ws.capacity(ws.size() + watch_cnt[i]); }
+        if (bin_cnt[i] > 0){
+            WatchList& ws = watches_bin[toLit(i)];
+            ws.capacity(ws.size() + bin_cnt[i]); }
+    }
+
+    // In order, as 'addClause_()' (units are propagated right away, so later clauses see them):
+    for (int i = 0; i < n; i++){
+        if (sizes[i] < 0) continue;
+        Lit* c = (Lit*)lits + offsets[i];
+        int  j = 0, k;
+        for (k = 0; k < sizes[i]; k++)
+            if (value(c[k]) == l_True) break;
+            else if (value(c[k]) != l_False) c[j++] = c[k];
+        if (k < sizes[i]) continue;
+
+        if (j == 0) return ok = false;
+        else if (j == 1){
+            uncheckedEnqueue(c[0]);
+            if (propagate() != CRef_Undef) return ok = false;
+        }else{
+            CRef cr = ca.alloc(LitSpan(c, j), false);
+            clauses.push(cr);
+            attachClause(cr);
+        }
+    }
+    return true;
+}
+
+
 void Solver::attachClause(CRef cr){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
-    watches[~c[0]].push(Watcher(cr, c[1]));
-    watches[~c[1]].push(Watcher(cr, c[0]));
-    if (c.learnt()) {
-        num_learnts++, learnts_literals += c.size();
-        //TEMPLATE BEGIN LEARNT CLAUSE STATISTICES ATTACH
-    }
-    else {
-        num_clauses++, clauses_literals += c.size();
-        //TEMPLATE BEGIN ORIGINAL CLAUSE STATISTICS ATTACH
-    }
-    //TEMPLATE BEGIN GENERAL CLAUSE STATISTICS ATTACH
+    WatchLists& ws = c.size() == 2 ? watches_bin : watches;
+    ws[~c[0]].push(Watcher(cr, c[1]));
+    ws[~c[1]].push(Watcher(cr, c[0]));
+    if (c.learnt()) num_learnts++, learnts_literals += c.size();
+    else            num_clauses++, clauses_literals += c.size();
 }
 
 
 void Solver::detachClause(CRef cr, bool strict){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
+    WatchLists& ws = c.size() == 2 ? watches_bin : watches;
     if (strict){
-        remove(watches[~c[0]], Watcher(cr, c[1]));
-        remove(watches[~c[1]], Watcher(cr, c[0]));
+        remove(ws[~c[0]], Watcher(cr, c[1]));
+        remove(ws[~c[1]], Watcher(cr, c[0]));
     }else{
-        watches.smudge(~c[0]);
-        watches.smudge(~c[1]);
+        ws.smudge(~c[0]);
+        ws.smudge(~c[1]);
     }
 
-    if (c.learnt()) {
-        num_learnts--, learnts_literals -= c.size();
-        //TEMPLATE BEGIN LEARNT CLAUSE STATISTICS DETACH
-    }
-    else {
-        num_clauses--, clauses_literals -= c.size();
-        //TEMPLATE END ORIGINAL CLAUSE STATISTICS DETACH
-    }
-    //TEMPLATE GENERAL CLAUSE STATISTICS DETACH
+    if (c.learnt()) num_learnts--, learnts_literals -= c.size();
+    else            num_clauses--, clauses_literals -= c.size();
 }
 
 
@@ -250,6 +366,7 @@ void Solver::cancelUntil(int level) {
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var      x  = var(trail[c]);
             assigns [x] = l_Undef;
+            lit_value[trail[c]] = lit_value[~trail[c]] = 0;
             if (phase_saving > 1 || (phase_saving == 1 && c > trail_lim.last()))
                 polarity[x] = sign(trail[c]);
             insertVarOrder(x); 
@@ -260,45 +377,123 @@ void Solver::cancelUntil(int level) {
     } 
 }
 
-void Solver::get_clause_variable_ratio(){
-    mtx.lock();
-        waitingThreads++;
-    mtx.unlock();
-    sem_wait(&propagationDone);
-    long vars = 0,clause = 0;
-    for (int i = 0;i < nVars();i++) seenx[i]=0;
-    for (int i = 0; i < clauses.size();i++){
+/*_________________________________________________________________________________________________
+|
+|  clauseVariableRatio : ()  ->  [double]
+|
+|  Description:
+|    Number of original clauses not yet satisfied by the current assignment, divided by the number
+|    of distinct unassigned variables occurring in them. Runs in the solving thread (at restarts),
+|    so it sees a consistent trail and needs no synchronization with observers.
+|________________________________________________________________________________________________@*/
+double Solver::clauseVariableRatio()
+{
+    int unsat = 0;
+    ratio_toclear.clear();
+    for (int i = 0; i < clauses.size(); i++){
         const Clause& c = ca[clauses[i]];
-        vec<Var> curr_clause;
-        bool flag = false;
-        for (int j = 0;j < c.size();j++){
+        if (satisfied(c)) continue;
+        unsat++;
+        for (int j = 0; j < c.size(); j++){
             Var v = var(c[j]);
-            if (assigns[v] == l_Undef){
-                if (!seenx[v]) {
-                    curr_clause.push(v);
-                    seenx[v]=1;
-                    vars++;
-                }
-            }
-            if (value(c[j]) == l_True){
-                flag = true;
-                break;
-            }
+            if (value(v) == l_Undef && !seen[v]){
+                seen[v] = 1;
+                ratio_toclear.push(v); }
         }
-        if (flag){
-            for (int i = 0;i < curr_clause.size();i++) {
-                seenx[curr_clause[i]] = 0;
-                vars--;
-            }
-        }
-        else clause++;
     }
-    (threadedTimestamp.size()==0)?threadedTimestamp.push(1):threadedTimestamp.push(threadedTimestamp.last()+1);
-    clauseVariableRatioVector.push((double)clause/vars);
-    sem_post(&calculationDone);
-    mtx.lock();
-        waitingThreads--;
-    mtx.unlock();
+
+    for (int i = 0; i < ratio_toclear.size(); i++)
+        seen[ratio_toclear[i]] = 0;     // ('seen[]' is now cleared)
+
+    return ratio_toclear.size() == 0 ? 0 : (double)unsat / ratio_toclear.size();
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  computeLBD : (c : const vec<Lit>&)  ->  [int]
+|
+|  Description:
+|    Number of distinct decision levels among the literals of 'c' (its "literal block distance").
+|    Levels are marked with a per-call stamp, so nothing needs to be cleared afterwards.
+|________________________________________________________________________________________________@*/
+int Solver::computeLBD(const vec<Lit>& c)
+{
+    if (++lbd_counter == 0){
+        for (int i = 0; i < lbd_stamp.size(); i++) lbd_stamp[i] = 0;
+        lbd_counter = 1; }
+    lbd_stamp.growTo(decisionLevel() + 1, 0);
+
+    int lbd = 0;
+    for (int i = 0; i < c.size(); i++){
+        int l = level(var(c[i]));
+        if (lbd_stamp[l] != lbd_counter){
+            lbd_stamp[l] = lbd_counter;
+            lbd++; }
+    }
+    return lbd;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  updateConflictStats : (learnt : const vec<Lit>&) (backtrack_level : int)  ->  [void]
+|
+|  Description:
+|    Folds one conflict into the moving averages of LBD, backjump distance and conflict level.
+|    Must be called after 'analyze()' and before 'cancelUntil()', while the levels of the literals
+|    in 'learnt' are still valid.
+|________________________________________________________________________________________________@*/
+void Solver::updateConflictStats(const vec<Lit>& learnt, int backtrack_level)
+{
+    int lbd = computeLBD(learnt);
+
+    if (conflicts == 1){
+        ema_lbd            = lbd;
+        ema_backjump       = decisionLevel() - backtrack_level;
+        ema_conflict_level = decisionLevel();
+    }else{
+        ema_lbd            += conflictStatsAlpha * (lbd - ema_lbd);
+        ema_backjump       += conflictStatsAlpha * ((decisionLevel() - backtrack_level) - ema_backjump);
+        ema_conflict_level += conflictStatsAlpha * (decisionLevel() - ema_conflict_level);
+    }
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  topKActivity : (k : int)  ->  [double]
+|
+|  Description:
+|    Average activity of the 'k' most active variables in 'order_heap', relative to 'var_inc' so
+|    that values stay comparable across rescaling. Walks the heap best-first from the root, keeping
+|    a frontier of at most 'k+1' candidates, instead of sorting 'activity': O(k^2) independent of
+|    the number of variables.
+|________________________________________________________________________________________________@*/
+double Solver::topKActivity(int k)
+{
+    if (k <= 0 || order_heap.empty()) return 0;
+
+    double sum   = 0;
+    int    taken = 0;
+    topk_frontier.clear();
+    topk_frontier.push(0);
+    while (taken < k && topk_frontier.size() > 0){
+        int best = 0;
+        for (int i = 1; i < topk_frontier.size(); i++)
+            if (activity[order_heap[topk_frontier[i]]] > activity[order_heap[topk_frontier[best]]])
+                best = i;
+        int idx = topk_frontier[best];
+        topk_frontier[best] = topk_frontier.last();
+        topk_frontier.pop();
+
+        sum += activity[order_heap[idx]];
+        taken++;
+        if (idx*2+1 < order_heap.size()) topk_frontier.push(idx*2+1);
+        if (idx*2+2 < order_heap.size()) topk_frontier.push(idx*2+2);
+    }
+
+    return sum / taken / var_inc;
 }
 
 
@@ -352,11 +547,23 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel){
     int index   = trail.size() - 1;
     do{
         assert(confl != CRef_Undef); 
-        Clause& c = ca[confl];
-        if (c.learnt()) claBumpActivity(c);
+        const Lit* lits;
+        int        size;
+        Lit        bin[2];
+        if (p != lit_Undef && isBinReason(confl))
+            lits = reasonLits(p, bin, size);
+        else{
+            Clause& c = ca[confl];
+            if (c.learnt()) claBumpActivity(c);
+            if (c.imported()){
+                c.imported(false);
+                shared_useful++; }
+            lits = c;
+            size = c.size();
+        }
 
-        for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
-            Lit q = c[j];
+        for (int j = (p == lit_Undef) ? 0 : 1; j < size; j++){
+            Lit q = lits[j];
 
             if (!seen[var(q)] && level(var(q)) > 0){
                 varBumpActivity(var(q));
@@ -390,8 +597,10 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel){
             if (reason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = ca[reason(var(out_learnt[i]))];
-                for (int k = 1; k < c.size(); k++)
+                Lit        bin[2];
+                int        size;
+                const Lit* c = reasonLits(out_learnt[i], bin, size);
+                for (int k = 1; k < size; k++)
                     if (!seen[var(c[k])] && level(var(c[k])) > 0){
                         out_learnt[j++] = out_learnt[i];
                         break; 
@@ -426,13 +635,15 @@ bool Solver::litRedundant(Lit p){
     assert(seen[var(p)] == seen_undef || seen[var(p)] == seen_source);
     assert(reason(var(p)) != CRef_Undef);
 
-    Clause* c = &ca[reason(var(p))];
+    Lit        bin[2];
+    int        size;
+    const Lit* c = reasonLits(p, bin, size);
     vec<ShrinkStackElem>& stack = analyze_stack;
     stack.clear();
 
     for (uint32_t i = 1; ; i++){
-        if (i < (uint32_t)c->size()){
-            Lit l = (*c)[i];
+        if (i < (uint32_t)size){
+            Lit l = c[i];
             if (level(var(l)) == 0 || seen[var(l)] == seen_source || seen[var(l)] == seen_removable){
                 continue; 
             }
@@ -449,7 +660,7 @@ bool Solver::litRedundant(Lit p){
             stack.push(ShrinkStackElem(i, p));
             i  = 0;
             p  = l;
-            c  = &ca[reason(var(p))];
+            c  = reasonLits(p, bin, size);
         }
         else{
             if (seen[var(p)] == seen_undef){
@@ -459,7 +670,7 @@ bool Solver::litRedundant(Lit p){
             if (stack.size() == 0) break;
             i  = stack.last().i;
             p  = stack.last().l;
-            c  = &ca[reason(var(p))];
+            c  = reasonLits(p, bin, size);
 
             stack.pop();
         }
@@ -495,8 +706,10 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict){
                 out_conflict.insert(~trail[i]);
             }
             else{
-                Clause& c = ca[reason(x)];
-                for (int j = 1; j < c.size(); j++)
+                Lit        bin[2];
+                int        size;
+                const Lit* c = reasonLits(trail[i], bin, size);
+                for (int j = 1; j < size; j++)
                     if (level(var(c[j])) > 0)
                         seen[var(c[j])] = 1;
             }
@@ -510,18 +723,78 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict){
 void Solver::uncheckedEnqueue(Lit p, CRef from){
     assert(value(p) == l_Undef);
     assigns[var(p)] = lbool(!sign(p));
+    lit_value[p]    = 1;
+    lit_value[~p]   = -1;
     vardata[var(p)] = mkVarData(from, decisionLevel());
     trail.push_(p);
 }
 
 
+// With 'MINISAT_PREFETCH' (a CMake option), 'propagate()' prefetches the clause of the watcher this
+// many places ahead, unless its blocker is already true, and the watch list of the next literal on
+// the trail. Clause reads from a large arena are cache misses otherwise, and each one stalls the scan.
+#ifdef MINISAT_PREFETCH
+static const int prefetch_ahead = 4;
+#else
+static const int prefetch_ahead = 0;
+#endif
+
+
+// First literal in 'lits[from..to)' that is not false, or 'to' if there is none. 'vals' is
+// 'lit_value', which must have 3 bytes to spare after its last entry for the AVX2 version, as it
+// reads 4 bytes per literal. The version is picked once, on first use:
+typedef int (*ScanFn)(const Lit* lits, int from, int to, const int8_t* vals);
+
+static int firstNonFalse(const Lit* lits, int from, int to, const int8_t* vals)
+{
+    for (int k = from; k < to; k++)
+        if (vals[toInt(lits[k])] >= 0) return k;
+    return to;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+__attribute__((target("avx2")))
+static int firstNonFalseAVX2(const Lit* lits, int from, int to, const int8_t* vals)
+{
+    const __m256i false_byte = _mm256_set1_epi32(0xff);
+    int k = from;
+    for (; k + 8 <= to; k += 8){
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(lits + k));
+        __m256i v   = _mm256_and_si256(_mm256_i32gather_epi32((const int*)vals, idx, 1), false_byte);
+        unsigned m  = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, false_byte))) & 0xff;
+        if (m != 0) return k + __builtin_ctz(m);
+    }
+    return firstNonFalse(lits, k, to, vals);
+}
+
+static ScanFn pickScan()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? firstNonFalseAVX2 : firstNonFalse;
+}
+#else
+static ScanFn pickScan() { return firstNonFalse; }
+#endif
+
+// Most searches end within a few literals of where they start, so these are checked inline:
+static inline int scanLong(const Lit* lits, int from, int to, const int8_t* vals)
+{
+    static const ScanFn scan = pickScan();
+    int k = from, probe = to - from > 4 ? from + 4 : to;
+    for (; k < probe; k++)
+        if (vals[toInt(lits[k])] >= 0) return k;
+    return k < to ? scan(lits, k, to, vals) : to;
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  propagate : [void]  ->  [Clause*]
 |  
 |  Description:
 |    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
-|    otherwise CRef_Undef.
+|    otherwise CRef_Undef. For each fact, the binary clauses are propagated first, from the
+|    watchers alone (see 'isBinReason()'), then the longer clauses.
 |  
 |    Post-conditions:
 |      * the propagation queue is empty, even if there was a conflict.
@@ -533,12 +806,29 @@ CRef Solver::propagate(){
 
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];    
-        vec<Watcher>&  ws  = watches.lookup(p);
-        Watcher        *i, *j, *end;
         num_props++;
+        if (prefetch_ahead > 0 && qhead < trail.size())
+            __builtin_prefetch((const Watcher*)watches[trail[qhead]]);
+
+        WatchList&     bws = watches_bin.lookup(p);
+        for (int k = 0; k < bws.size(); k++){
+            Lit imp = bws[k].blocker;
+            if (lit_value[imp] < 0){
+                confl = bws[k].cref;
+                qhead = trail.size();
+                break; }
+            if (lit_value[imp] == 0)
+                uncheckedEnqueue(imp, mkBinReason(~p));
+        }
+        if (confl != CRef_Undef) break;
+
+        WatchList&     ws  = watches.lookup(p);
+        Watcher        *i, *j, *end;
         for (i = j = (Watcher*)ws, end = i + ws.size(); i != end;){
+            if (prefetch_ahead > 0 && end - i > prefetch_ahead && lit_value[i[prefetch_ahead].blocker] <= 0)
+                __builtin_prefetch(ca.lea(i[prefetch_ahead].cref));
             Lit blocker = i->blocker;
-            if (value(blocker) == l_True){
+            if (lit_value[blocker] > 0){
                 *j++ = *i++; 
                 continue; 
             }
@@ -550,20 +840,28 @@ CRef Solver::propagate(){
             i++;
             Lit     first = c[0];
             Watcher w     = Watcher(cr, first);
-            if (first != blocker && value(first) == l_True){
+            if (first != blocker && lit_value[first] > 0){
                 *j++ = w; continue; 
             }
 
-            for (int k = 2; k < c.size(); k++){
-                if (value(c[k]) != l_False){
-                    c[1] = c[k]; c[k] = false_lit;
-                    watches[~c[1]].push(w);
-                    goto NextClause; 
-                }
+            int sz = c.size(), k;
+            if (c.has_pos()){
+                // Continue from where the last search stopped, then wrap around:
+                int pos = c.searchPos();
+                if ((k = scanLong(c, pos, sz, lit_value.begin())) == sz && (k = scanLong(c, 2, pos, lit_value.begin())) == pos)
+                    k = sz;
+                else
+                    c.searchPos() = k;
+            }else
+                for (k = 2; k < sz && lit_value[c[k]] < 0; k++);
+            if (k < sz){
+                c[1] = c[k]; c[k] = false_lit;
+                watches[~c[1]].push(w);
+                goto NextClause; 
             }
 
             *j++ = w;
-            if (value(first) == l_False){
+            if (lit_value[first] < 0){
                 confl = cr;
                 qhead = trail.size();
                 while (i < end) *j++ = *i++;
@@ -620,12 +918,19 @@ void Solver::removeSatisfied(vec<CRef>& cs){
         if (satisfied(c)) removeClause(cs[i]);
         else{
             assert(value(c[0]) == l_Undef && value(c[1]) == l_Undef);
+            bool was_long = c.size() > 2;
             for (int k = 2; k < c.size(); k++){
                 if (value(c[k]) == l_False){
                     c[k--] = c[c.size()-1];
                     c.pop();
                 }
             }
+            if (was_long && c.size() == 2){
+                // Now binary, so it moves to the binary watch lists:
+                remove(watches[~c[0]], Watcher(cs[i], c[1]));
+                remove(watches[~c[1]], Watcher(cs[i], c[0]));
+                watches_bin[~c[0]].push(Watcher(cs[i], c[1]));
+                watches_bin[~c[1]].push(Watcher(cs[i], c[0])); }
             cs[j++] = cs[i];
         }
     }
@@ -710,16 +1015,17 @@ lbool Solver::search(int nof_conflicts){
     int         conflictC = 0;
     vec<Lit>    learnt_clause;
     starts++;
+    if (exchange != NULL && !importClauses()) return l_False;
 
     for (;;){
-        if (vizFlag && waitingThreads) sem_wait(&calculationDone);
         CRef confl = propagate();
-        if (vizFlag) sem_post(&propagationDone);
         if (confl != CRef_Undef){
             conflicts++; conflictC++;
             if (decisionLevel() == 0) return l_False;
             learnt_clause.clear();
             analyze(confl, learnt_clause, backtrack_level);
+            if (vizEnabled()) updateConflictStats(learnt_clause, backtrack_level);
+            if (exchange != NULL) exportClause(learnt_clause);
             cancelUntil(backtrack_level);
             if (learnt_clause.size() == 1) uncheckedEnqueue(learnt_clause[0]);
             else{
@@ -727,8 +1033,9 @@ lbool Solver::search(int nof_conflicts){
                 learnts.push(cr);
                 attachClause(cr);
                 claBumpActivity(ca[cr]);
-                uncheckedEnqueue(learnt_clause[0],cr);
+                uncheckedEnqueue(learnt_clause[0], learnt_clause.size() == 2 ? mkBinReason(learnt_clause[1]) : cr);
             }
+            if (vizEnabled()) publishSnapshot(sampleConflicts > 0 && conflicts % sampleConflicts == 0);
             varDecayActivity();
             claDecayActivity();
             if (--learntsize_adjust_cnt == 0){
@@ -736,7 +1043,7 @@ lbool Solver::search(int nof_conflicts){
                 learntsize_adjust_cnt    = (int)learntsize_adjust_confl;
                 max_learnts             *= learntsize_inc;
                 if (verbosity >= 1){
-                    if (!vizFlag){
+                    if (!vizEnabled()){
                         printf("| %9d | %7d %8d %8d | %8d %8d %6.0f | %6.3f %% |\n", 
                            (int)conflicts, 
                            (int)dec_vars - (trail_lim.size() == 0 ? trail.size() : trail_lim[0]), nClauses(), (int)clauses_literals, 
@@ -756,12 +1063,15 @@ lbool Solver::search(int nof_conflicts){
         else{
             if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()){
                 progress_estimate = progressEstimate();
+                if (vizEnabled() && trackClauseVarRatio) clause_var_ratio = clauseVariableRatio();
                 cancelUntil(0);
                 return l_Undef; 
             }
 
             if (decisionLevel() == 0 && !simplify()) return l_False;
-            if (learnts.size()-nAssigns() >= max_learnts) reduceDB();
+            if (learnts.size()-nAssigns() >= max_learnts){
+                reduceDB();
+                if (vizEnabled() && sampleReduceDB) publishSnapshot(true); }
 
             Lit next = lit_Undef;
             while (decisionLevel() < assumptions.size()){
@@ -783,7 +1093,7 @@ lbool Solver::search(int nof_conflicts){
                 decisions++;
                 next = pickBranchLit();
                 if (next == lit_Undef) return l_True;
-                averageActivity += activity[var(next)];
+                if (vizEnabled()) averageActivity += activity[var(next)];
             }
 
             newDecisionLevel();
@@ -793,6 +1103,132 @@ lbool Solver::search(int nof_conflicts){
 }
 
 
+// Number of propagations between two checks of the CPU-time and memory budgets. Reading the
+// thread CPU clock is a system call, so it is not done on every call to 'withinBudget()'.
+static const uint64_t resource_check_interval = 16384;
+
+bool Solver::withinResourceBudget() const
+{
+    if ((cpu_budget >= 0 && threadCpuTime() >= cpu_budget)
+     || (mem_budget > 0  && memUsedEstimate() >= mem_budget))
+        return false;   // ('next_resource_check' is left as is, so this is re-checked on every call)
+
+    next_resource_check = propagations + resource_check_interval;
+    return true;
+}
+
+
+uint64_t Solver::memUsedEstimate() const
+{
+    uint64_t per_var = sizeof(lbool) + sizeof(VarData) + sizeof(double) + sizeof(Lit) + 4 * sizeof(char)
+                     + 4 * sizeof(WatchList) + 2 * sizeof(int);
+    return (uint64_t)ca.size() * sizeof(uint32_t)
+         + (watches.size() + watches_bin.size()) * sizeof(Watcher)
+         + (uint64_t)nVars() * per_var;
+}
+
+
+//=================================================================================================
+// Clause exchange:
+
+
+void Solver::setClauseExchange(ClauseExchange* x, int id)
+{
+    assert(x == NULL || (id >= 0 && id < x->participants()));
+    exchange    = x;
+    exchange_id = id;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  exportClause : (learnt : const vec<Lit>&)  ->  [void]
+|
+|  Description:
+|    Offers a freshly learnt clause to the other participants if it passes the exchange's filter:
+|    units and binaries always, otherwise clauses of at most 'max_size' literals and 'max_lbd'
+|    decision levels. Must be called before 'cancelUntil()', while the levels are still valid.
+|________________________________________________________________________________________________@*/
+void Solver::exportClause(const vec<Lit>& learnt)
+{
+    int lbd = learnt.size();
+    if (learnt.size() > 2){
+        if (learnt.size() > exchange->max_size || learnt.size() > ClauseExchange::Max_Size) return;
+        lbd = computeLBD(learnt);
+        if (lbd > exchange->max_lbd) return; }
+
+    exchange->publish(exchange_id, learnt, lbd);
+    shared_exported++;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  importClauses : ()  ->  [bool]
+|
+|  Description:
+|    Adds the clauses published by the other participants since the last call, at decision level 0.
+|    Literals false at the top level are dropped and satisfied clauses skipped. Units are enqueued
+|    (and propagated by the caller); longer clauses become learnt clauses attached the normal way,
+|    flagged as imported until they first take part in a conflict ('shared_useful'). Clauses over
+|    variables this solver does not branch on (e.g. eliminated ones) are ignored. Returns FALSE
+|    if an imported clause is falsified at the top level.
+|________________________________________________________________________________________________@*/
+bool Solver::importClauses()
+{
+    assert(decisionLevel() == 0);
+    shared_lost += exchange->collect(exchange_id, import_tmp, [this](vec<Lit>& c, int){
+        if (!ok) return;
+        int i, j;
+        for (i = j = 0; i < c.size(); i++){
+            Var v = var(c[i]);
+            if (v >= nVars() || !decision[v] || value(c[i]) == l_True) return;
+            if (value(c[i]) != l_False) c[j++] = c[i];
+        }
+        c.shrink(i - j);
+        shared_imported++;
+
+        if (c.size() == 0)
+            ok = false;
+        else if (c.size() == 1)
+            uncheckedEnqueue(c[0]);
+        else{
+            CRef cr = ca.alloc(c, true);
+            ca[cr].imported(true);
+            learnts.push(cr);
+            attachClause(cr);
+            claBumpActivity(ca[cr]);
+        }
+    });
+    return ok;
+}
+
+
+void Solver::publishSnapshot(bool sample){
+    Snapshot s;
+    s.time              = realTime() - vizStartTime;
+    s.decisions         = decisions;
+    s.propagations      = propagations;
+    s.conflicts         = conflicts;
+    s.restarts          = curr_restarts;
+    s.num_clauses       = num_clauses;
+    s.num_learnts       = num_learnts;
+    s.learnts_literals  = learnts_literals;
+    s.gc_events         = (uint64_t)gcEvents;
+    s.mem_used          = memUsedEstimate();
+    s.shared_exported   = shared_exported;
+    s.shared_imported   = shared_imported;
+    s.shared_useful     = shared_useful;
+    s.clause_var_ratio  = clause_var_ratio;
+    s.avg_lbd           = ema_lbd;
+    s.backjump_distance = ema_backjump;
+    s.conflict_level    = ema_conflict_level;
+    s.avg_topk_activity = avg_topk_activity;
+    statsSnapshot.write(s);
+    if (sample) samples.push(s);
+}
+
+
 double Solver::progressEstimate() const{
     double  progress = 0;
     double  F = 1.0 / nVars();
@@ -835,16 +1271,19 @@ lbool Solver::solve_(){
     model.clear();
     conflict.clear();
     if (!ok) return l_False;
-    solves++;
-    max_learnts = nClauses() * learntsize_factor;
-    if (max_learnts < min_learnts_lim) max_learnts = min_learnts_lim;
+    if (!resuming){
+        solves++;
+        max_learnts = nClauses() * learntsize_factor;
+        if (max_learnts < min_learnts_lim) max_learnts = min_learnts_lim;
 
-    learntsize_adjust_confl   = learntsize_adjust_start_confl;
-    learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
+        learntsize_adjust_confl   = learntsize_adjust_start_confl;
+        learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
+    }
+    resuming                  = false;
     lbool   status            = l_Undef;
 
     if (verbosity >= 1){
-        if (!vizFlag){
+        if (!vizEnabled()){
             printf("============================[ Search Statistics ]==============================\n");
             printf("| Conflicts |          ORIGINAL         |          LEARNT          | Progress |\n");
             printf("|           |    Vars  Clauses Literals |    Limit  Clauses Lit/Cl |          |\n");
@@ -859,16 +1298,33 @@ lbool Solver::solve_(){
         }
     }
 
-    if (vizFlag) {for (int i = 0; i < nVars();i++) seenx.insert(i,false);}
+    if (vizEnabled()) {
+        if (solves == 1) vizStartTime = realTime();
+        publishSnapshot();
+    }
+    solving         = true;
+    next_checkpoint = realTime() + checkpoint_interval;
     while (status == l_Undef){
         double rest_base = luby_restart ? luby(restart_inc, curr_restarts) : pow(restart_inc, curr_restarts);
         status = search(rest_base * restart_first);
         if (!withinBudget()) break;
         curr_restarts++;
+        if (status == l_Undef && checkpoint_file != NULL
+            && (checkpoint_requested || (checkpoint_interval > 0 && realTime() >= next_checkpoint))){
+            checkpoint_requested = 0;
+            if (!writeCheckpoint(checkpoint_file))
+                fprintf(stderr, "WARNING! Could not write checkpoint: %s\n", checkpoint_file);
+            next_checkpoint = realTime() + checkpoint_interval;
+        }
+        if (vizEnabled()){
+            avg_topk_activity = topKActivity(activityTopK);
+            publishSnapshot(sampleRestarts); }
     }
+    solving = false;
+    if (vizEnabled()) publishSnapshot(true);
 
     if (verbosity >= 1){
-        if (!vizFlag) printf("===============================================================================\n");
+        if (!vizEnabled()) printf("===============================================================================\n");
         else {
             fprintf(logFile,"===============================================================================\n");
             fflush(logFile);
@@ -913,8 +1369,9 @@ bool Solver::implies(const vec<Lit>& assumps, vec<Lit>& out){
 
 //=================================================================================================
 // Writing CNF to DIMACS:
-// 
-// FIXME: this needs to be rewritten completely.
+//
+// Variables are renumbered in order of first occurrence, skipping those that only occur in
+// satisfied clauses or as false literals. All text goes through an 'OutputBuffer'.
 
 static Var mapVar(Var x, vec<Var>& map, Var& max){
     if (map.size() <= x || map[x] == -1){
@@ -925,80 +1382,407 @@ static Var mapVar(Var x, vec<Var>& map, Var& max){
 }
 
 
-void Solver::toDimacs(FILE* f, Clause& c, vec<Var>& map, Var& max)
+void Solver::toDimacs(OutputBuffer& out, Clause& c, vec<Var>& map, Var& max)
 {
     if (satisfied(c)) return;
 
     for (int i = 0; i < c.size(); i++)
-        if (value(c[i]) != l_False)
-            fprintf(f, "%s%d ", sign(c[i]) ? "-" : "", mapVar(var(c[i]), map, max)+1);
-    fprintf(f, "0\n");
+        if (value(c[i]) != l_False){
+            Var x = mapVar(var(c[i]), map, max) + 1;
+            out.putInt(sign(c[i]) ? -x : x);
+            out.put(' '); }
+    out.put("0\n");
 }
 
 
 void Solver::toDimacs(const char *file, const vec<Lit>& assumps){
-    FILE* f = fopen(file, "wr");
+    FILE* f = fopen(file, "wb");
     if (f == NULL) fprintf(stderr, "could not open file %s\n", file), exit(1);
     toDimacs(f, assumps);
     fclose(f);
 }
 
 
-void Solver::toDimacsLearnt(const char *file){
-    if (file == NULL) {
-        fprintf(stderr, "could not open file \n");
-        return;
-    }
-    char c[100]; 
-    strcpy(c, file);
-    char num[60];
-    sprintf(num,"%d",iter);
-    strcat(c, num);
-    char* x = ".cnf";
-    strcat(c,x);
-    FILE* f = fopen(c,"wr");
-    for (int i = 0; i < clauses.size();i++){
-        CRef& c = clauses[i];
-        Clause& clause = ca[c];
-        for (int j = 0; j < clause.size();j++) fprintf(f,"%s%d ",sign(clause[j])?"-":"",1+var(clause[j]));
-        fprintf(f, "0\n");
-    }
+// Writes the top-level facts as unit clauses, then the learnt clauses, each preceded by a comment
+// line with its activity. Variables keep their numbers. The file name is 'prefix', a running count
+// of the dumps made so far ('iter') and '.cnf':
+void Solver::toDimacsLearnt(const char* prefix){
+    if (prefix == NULL) return;
+    std::string file = std::string(prefix) + std::to_string(iter) + ".cnf";
+    FILE* f = fopen(file.c_str(), "wb");
+    if (f == NULL){
+        fprintf(stderr, "could not open file %s\n", file.c_str());
+        return; }
+    toDimacsLearnt(f);
+    fclose(f);
     iter++;
 }
 
-void Solver::toDimacs(FILE* f, const vec<Lit>& assumps){
 
+void Solver::toDimacsLearnt(FILE* f){
+    OutputBuffer out(f);
+    int          units = trail_lim.size() == 0 ? trail.size() : trail_lim[0];
+    out.put("p cnf ");
+    out.putInt(nVars());
+    out.put(' ');
+    out.putInt(units + learnts.size());
+    out.put('\n');
+
+    for (int i = 0; i < units; i++){
+        out.putInt(sign(trail[i]) ? -(var(trail[i])+1) : var(trail[i])+1);
+        out.put(" 0\n"); }
+
+    for (int i = 0; i < learnts.size(); i++){
+        Clause& c = ca[learnts[i]];
+        out.put("c activity ");
+        out.putDouble(c.activity());
+        out.put('\n');
+        for (int j = 0; j < c.size(); j++){
+            out.putInt(sign(c[j]) ? -(var(c[j])+1) : var(c[j])+1);
+            out.put(' '); }
+        out.put("0\n");
+    }
+}
+
+
+void Solver::toDimacs(FILE* f, const vec<Lit>& assumps){
+    OutputBuffer out(f);
     if (!ok){
-        fprintf(f, "p cnf 1 2\n1 0\n-1 0\n");
+        out.put("p cnf 1 2\n1 0\n-1 0\n");
         return; 
     }
+
+    // The header comes first and the output may be a pipe, so the numbering and the clauses to
+    // write are settled in a separate pass:
+    vec<Var>  map; Var max = 0;
+    vec<CRef> live;
+    for (int i = 0; i < clauses.size(); i++){
+        Clause& c = ca[clauses[i]];
+        if (satisfied(c)) continue;
+        live.push(clauses[i]);
+        for (int j = 0; j < c.size(); j++)
+            if (value(c[j]) != l_False) mapVar(var(c[j]), map, max);
+    }
+    for (int i = 0; i < assumps.size(); i++)
+        mapVar(var(assumps[i]), map, max);
+
+    int cnt = live.size() + assumps.size();
+    out.put("p cnf ");
+    out.putInt(max);
+    out.put(' ');
+    out.putInt(cnt);
+    out.put('\n');
+
+    for (int i = 0; i < assumps.size(); i++){
+        assert(value(assumps[i]) != l_False);
+        Var x = map[var(assumps[i])] + 1;
+        out.putInt(sign(assumps[i]) ? -x : x);
+        out.put(" 0\n");
+    }
+
+    for (int i = 0; i < live.size(); i++){
+        Clause& c = ca[live[i]];
+        for (int j = 0; j < c.size(); j++)
+            if (value(c[j]) != l_False){
+                Var x = map[var(c[j])] + 1;
+                out.putInt(sign(c[j]) ? -x : x);
+                out.put(' '); }
+        out.put("0\n");
+    }
+
+    if (verbosity > 0)
+        printf("Wrote DIMACS with %d variables and %d clauses.\n", max, cnt);
+}
+
+
+void Solver::toBinaryCnf(const char* file, const vec<Lit>& assumps){
+    FILE* f = fopen(file, "wb");
+    if (f == NULL) fprintf(stderr, "could not open file %s\n", file), exit(1);
+    toBinaryCnf(f, assumps);
+    fclose(f);
+}
+
+
+// Same clauses and variable numbering as 'toDimacs()':
+void Solver::toBinaryCnf(FILE* f, const vec<Lit>& assumps){
+    vec<Lit> lits;
+    if (!ok){
+        BinaryCnfWriter out(f, 1, 2);
+        lits.push(mkLit(0));
+        out.addClause(lits);
+        lits[0] = ~lits[0];
+        out.addClause(lits);
+        out.finish();
+        return;
+    }
     vec<Var> map; Var max = 0;
-    int cnt = 0;
-    for (int i = 0; i < clauses.size(); i++)
-        if (!satisfied(ca[clauses[i]]))
-            cnt++;
-        
+    int cnt = assumps.size();
     for (int i = 0; i < clauses.size(); i++)
         if (!satisfied(ca[clauses[i]])){
             Clause& c = ca[clauses[i]];
+            cnt++;
             for (int j = 0; j < c.size(); j++)
                 if (value(c[j]) != l_False) mapVar(var(c[j]), map, max);
         }
+    for (int i = 0; i < assumps.size(); i++)
+        mapVar(var(assumps[i]), map, max);
 
-    cnt += assumps.size();
-
-    fprintf(f, "p cnf %d %d\n", max, cnt);
-
+    BinaryCnfWriter out(f, max, cnt);
     for (int i = 0; i < assumps.size(); i++){
         assert(value(assumps[i]) != l_False);
-        fprintf(f, "%s%d 0\n", sign(assumps[i]) ? "-" : "", mapVar(var(assumps[i]), map, max)+1);
+        lits.clear();
+        lits.push(mkLit(mapVar(var(assumps[i]), map, max), sign(assumps[i])));
+        out.addClause(lits);
     }
-
-    for (int i = 0; i < clauses.size(); i++)
-        toDimacs(f, ca[clauses[i]], map, max);
+    for (int i = 0; i < clauses.size(); i++){
+        Clause& c = ca[clauses[i]];
+        if (satisfied(c)) continue;
+        lits.clear();
+        for (int j = 0; j < c.size(); j++)
+            if (value(c[j]) != l_False)
+                lits.push(mkLit(mapVar(var(c[j]), map, max), sign(c[j])));
+        out.addClause(lits);
+    }
+    out.finish();
 
     if (verbosity > 0)
-        printf("Wrote DIMACS with %d variables and %d clauses.\n", max, cnt);
+        printf("Wrote binary CNF with %d variables and %d clauses.\n", max, cnt);
+}
+
+
+//=================================================================================================
+// Checkpoints:
+//
+// Taken at decision level 0 only (between restarts, or outside 'solve()'), where the trail holds
+// top-level facts and 'seen' is clear. Watcher lists and the decision heap are saved in their exact
+// order, so propagation and branching go on as if the solver had never stopped.
+
+
+bool Solver::writeCheckpoint(const char* file)
+{
+    std::string tmp = std::string(file) + ".tmp";
+    FILE*       f   = fopen(tmp.c_str(), "wb");
+    if (f == NULL) return false;
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    CheckpointWriter out(f);
+    out.putHeader();
+    bool done = saveState(out);
+    out.putChecksum();
+    done = done && out.okay();
+    done = fflush(f) == 0 && fsync(fileno(f)) == 0 && done;
+    done = fclose(f) == 0 && done;
+
+    // Only now replace the previous checkpoint, so there is always a complete one:
+    if (done && rename(tmp.c_str(), file) == 0) return true;
+    ::remove(tmp.c_str());
+    return false;
+}
+
+
+bool Solver::readCheckpoint(const char* file)
+{
+    if (nVars() != 0) return false;
+    FILE* f = fopen(file, "rb");
+    if (f == NULL) return false;
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    CheckpointReader in(f);
+    bool done = in.verify() && in.getHeader() && loadState(in);
+    in.getChecksum();
+    done = done && in.atEnd();
+    fclose(f);
+    return done;
+}
+
+
+bool Solver::saveState(CheckpointWriter& out)
+{
+    assert(decisionLevel() == 0);
+    watches.cleanAll();     // (Deleted watchers would be dropped before their next use anyway.)
+    watches_bin.cleanAll();
+
+    out.putTag("core");
+    out.put(next_var);
+    out.putVec(released_vars);
+    out.putVec(free_vars);
+    out.putMap(assigns);
+    out.putMap(vardata);
+    out.putMap(activity);
+    out.putMap(polarity);
+    out.putMap(user_pol);
+    out.putMap(decision);
+    out.putVec(trail);
+
+    vec<Var> heap;
+    for (int i = 0; i < order_heap.size(); i++)
+        heap.push(order_heap[i]);
+    out.putVec(heap);
+    for (int i = 0; i < 2*nVars(); i++){
+        const WatchList& ws  = watches    [toLit(i)];
+        const WatchList& bws = watches_bin[toLit(i)];
+        out.putVec((const Watcher*)ws,  ws .size());
+        out.putVec((const Watcher*)bws, bws.size()); }
+
+    // Clause database (learnt clause activities are stored in the arena):
+    out.put(ca.extra_clause_field);
+    out.put(ca.size());
+    out.put(ca.wasted());
+    out.write(ca.data(), sizeof(uint32_t) * (size_t)ca.size());
+    out.putVec(clauses);
+    out.putVec(learnts);
+
+    // Search state:
+    out.put(ok);
+    out.put(qhead);
+    out.put(cla_inc);
+    out.put(var_inc);
+    out.put(simpDB_assigns);
+    out.put(simpDB_props);
+    out.put(progress_estimate);
+    out.put(remove_satisfied);
+    out.put(random_seed);
+    out.put(max_learnts);
+    out.put(learntsize_adjust_confl);
+    out.put(learntsize_adjust_cnt);
+    out.put(curr_restarts);
+    out.put(solving);
+
+    // Statistics:
+    out.put(solves);           out.put(starts);           out.put(decisions);
+    out.put(rnd_decisions);    out.put(propagations);     out.put(conflicts);
+    out.put(dec_vars);         out.put(num_clauses);      out.put(num_learnts);
+    out.put(clauses_literals); out.put(learnts_literals); out.put(max_literals);
+    out.put(tot_literals);
+    out.put(shared_exported);  out.put(shared_imported);  out.put(shared_useful);
+    out.put(shared_lost);
+    out.put(gcEvents);         out.put(averageActivity);  out.put(clause_var_ratio);
+    out.put(ema_lbd);          out.put(ema_backjump);     out.put(ema_conflict_level);
+    out.put(avg_topk_activity);
+    return out.okay();
+}
+
+
+bool Solver::loadState(CheckpointReader& in)
+{
+    int n = 0;
+    in.getTag("core");
+    in.get(n);
+    if (!in.okay() || n < 0 || !in.fits(n, sizeof(lbool))) return false;
+    for (int v = 0; v < n; v++)
+        newVar();
+    in.getVec(released_vars);
+    in.getVec(free_vars);
+    in.getMap(assigns);
+    for (int v = 0; v < n; v++){
+        lbool b = assigns[v];
+        lit_value[mkLit(v)]  = b == l_Undef ? 0 : b == l_True ? 1 : -1;
+        lit_value[~mkLit(v)] = -lit_value[mkLit(v)]; }
+    in.getMap(vardata);
+    in.getMap(activity);
+    in.getMap(polarity);
+    in.getMap(user_pol);
+    in.getMap(decision);
+    in.getVec(trail);
+
+    vec<Var>  heap;
+    vec<char> in_heap(n, 0);
+    in.getVec(heap);
+    for (int i = 0; i < heap.size(); i++)
+        if (heap[i] < 0 || heap[i] >= n || in_heap[heap[i]]++) in.fail();
+    if (!in.okay()) return false;
+    order_heap.build(heap);     // (A valid heap, so nothing moves.)
+    for (int i = 0; i < 2*n; i++){
+        in.getVec(watches    [toLit(i)], Watcher(CRef_Undef, lit_Undef));
+        in.getVec(watches_bin[toLit(i)], Watcher(CRef_Undef, lit_Undef)); }
+
+    uint32_t size = 0, wasted = 0;
+    in.get(ca.extra_clause_field);
+    in.get(size);
+    in.get(wasted);
+    if (!in.okay() || !in.fits(size, sizeof(uint32_t))) return false;
+    in.read(ca.restore(size, wasted), sizeof(uint32_t) * (size_t)size);
+    in.getVec(clauses);
+    in.getVec(learnts);
+
+    in.get(ok);
+    in.get(qhead);
+    in.get(cla_inc);
+    in.get(var_inc);
+    in.get(simpDB_assigns);
+    in.get(simpDB_props);
+    in.get(progress_estimate);
+    in.get(remove_satisfied);
+    in.get(random_seed);
+    in.get(max_learnts);
+    in.get(learntsize_adjust_confl);
+    in.get(learntsize_adjust_cnt);
+    in.get(curr_restarts);
+    in.get(resuming);
+
+    in.get(solves);            in.get(starts);            in.get(decisions);
+    in.get(rnd_decisions);     in.get(propagations);      in.get(conflicts);
+    in.get(dec_vars);          in.get(num_clauses);       in.get(num_learnts);
+    in.get(clauses_literals);  in.get(learnts_literals);  in.get(max_literals);
+    in.get(tot_literals);
+    in.get(shared_exported);   in.get(shared_imported);   in.get(shared_useful);
+    in.get(shared_lost);
+    in.get(gcEvents);          in.get(averageActivity);   in.get(clause_var_ratio);
+    in.get(ema_lbd);           in.get(ema_backjump);      in.get(ema_conflict_level);
+    in.get(avg_topk_activity);
+    return in.okay() && validState();
+}
+
+
+// Every variable, literal and clause reference must be in range, and every watcher must refer to a
+// clause that watches its literal, or the first propagation reads outside the solver's memory:
+bool Solver::validState() const
+{
+    int n = nVars();
+    for (int i = 0; i < released_vars.size(); i++) if (released_vars[i] < 0 || released_vars[i] >= n) return false;
+    for (int i = 0; i < free_vars.size(); i++)     if (free_vars[i] < 0 || free_vars[i] >= n) return false;
+    if (next_var != n) return false;
+
+    // Clauses, marking where each one starts:
+    vec<char> start(ca.size(), 0);
+    for (int k = 0; k < 2; k++){
+        const vec<CRef>& cs = k == 0 ? clauses : learnts;
+        for (int i = 0; i < cs.size(); i++){
+            CRef cr = cs[i];
+            if (!ca.validRef(cr) || start[cr] || ca[cr].learnt() != (k == 1) || ca[cr].size() < 2) return false;
+            const Clause& c = ca[cr];
+            for (int j = 0; j < c.size(); j++)
+                if (var(c[j]) < 0 || var(c[j]) >= n) return false;
+            start[cr] = 1; } }
+
+    for (int i = 0; i < 2*n; i++){
+        Lit p = ~toLit(i);
+        for (int k = 0; k < 2; k++){
+            const WatchList& ws = k == 0 ? watches[toLit(i)] : watches_bin[toLit(i)];
+            for (int j = 0; j < ws.size(); j++){
+                CRef cr = ws[j].cref;
+                if (cr >= (CRef)start.size() || !start[cr]) return false;
+                const Clause& c = ca[cr];
+                if ((c.size() == 2) != (k == 1) || (c[0] != p && c[1] != p)
+                    || var(ws[j].blocker) < 0 || var(ws[j].blocker) >= n) return false; } } }
+
+    // Top-level assignments, which are exactly the variables on the trail:
+    if (trail.size() > n || qhead < 0 || qhead > trail.size()) return false;
+    int assigned = 0;
+    for (Var v = 0; v < n; v++){
+        if (toInt(assigns[v]) > 3) return false;
+        assigned += assigns[v] != l_Undef; }
+    if (assigned != trail.size()) return false;
+    vec<char> on_trail(n, 0);
+    for (int i = 0; i < trail.size(); i++){
+        Lit p = trail[i];
+        if (var(p) < 0 || var(p) >= n || on_trail[var(p)]++ || value(p) != l_True || level(var(p)) != 0) return false;
+        CRef r = reason(var(p));
+        if (isBinReason(r)){
+            if (var(binReasonLit(r)) < 0 || var(binReasonLit(r)) >= n) return false; }
+        else if (r != CRef_Undef && (r >= (CRef)start.size() || !start[r])) return false; }
+
+    return true;
 }
 
 
@@ -1010,6 +1794,8 @@ void Solver::printStats() const{
     printf("decisions             : %-12"PRIu64"   (%4.2f %% random) (%.0f /sec)\n", decisions, (float)rnd_decisions*100 / (float)decisions, decisions   /cpu_time);
     printf("propagations          : %-12"PRIu64"   (%.0f /sec)\n", propagations, propagations/cpu_time);
     printf("conflict literals     : %-12"PRIu64"   (%4.2f %% deleted)\n", tot_literals, (max_literals - tot_literals)*100 / (double)max_literals);
+    if (exchange != NULL)
+        printf("shared clauses        : %" PRIu64 " exported, %" PRIu64 " imported (%" PRIu64 " useful, %" PRIu64 " lost)\n", shared_exported, shared_imported, shared_useful, shared_lost);
     if (mem_used != 0) printf("Memory used           : %.2f MB\n", mem_used);
     printf("CPU time              : %g s\n", cpu_time);
 }
@@ -1023,19 +1809,27 @@ void Solver::relocAll(ClauseAllocator& to)
     // All watchers:
     //
     watches.cleanAll();
+    watches_bin.cleanAll();
     for (int v = 0; v < nVars(); v++)
         for (int s = 0; s < 2; s++){
             Lit p = mkLit(v, s);
-            vec<Watcher>& ws = watches[p];
+            WatchList& ws = watches[p];
             for (int j = 0; j < ws.size(); j++)
                 ca.reloc(ws[j].cref, to);
+            WatchList& bws = watches_bin[p];
+            for (int j = 0; j < bws.size(); j++)
+                ca.reloc(bws[j].cref, to);
         }
 
+    // Repack the watch lists, dropping the space of moved lists:
+    watches    .compact();
+    watches_bin.compact();
+
     // All reasons:
     //
     for (int i = 0; i < trail.size(); i++){
         Var v = var(trail[i]);
-        if (reason(v) != CRef_Undef && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
+        if (reason(v) != CRef_Undef && !isBinReason(reason(v)) && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
             assert(!isRemoved(reason(v)));
             ca.reloc(vardata[v].reason, to);
         }
@@ -25,15 +25,33 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/mtl/Heap.h"
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/IntMap.h"
+#include "minisat/mtl/SeqLock.h"
+#include "minisat/mtl/LockFreeQueue.h"
 #include <atomic>
+#include <signal.h>
 #include "minisat/utils/Options.h"
+#include "minisat/utils/System.h"
 #include "minisat/core/SolverTypes.h"
 #include <bits/stdc++.h>
-#include <semaphore.h>
 
 
 namespace Minisat {
 
+class ClauseExchange;
+class CheckpointWriter;
+class CheckpointReader;
+class OutputBuffer;
+
+//=================================================================================================
+// Visualizer instrumentation is only compiled in when 'MINISAT_VIZ' is defined (the 'minisat-viz'
+// library). In every other build 'Solver::vizEnabled()' is constant false and the hooks fold away.
+
+#ifdef MINISAT_VIZ
+static const bool viz_build = true;
+#else
+static const bool viz_build = false;
+#endif
+
 //=================================================================================================
 // Solver -- the main class:
 
@@ -53,6 +71,8 @@ public:
     bool    addClause (Lit p, Lit q, Lit r, Lit s);             // Add a quaternary clause to the solver. 
     bool    addClause_(vec<Lit>& ps);                     // Add a clause to the solver without making superflous internal copy. Will
     double  sumPercentage;                                                   // change the passed vector 'ps'.
+    bool    addClauses(vec<Lit>& lits, const vec<int>& offsets);   // Add many clauses at once (see definition). Changes 'lits'.
+    void    reserveVars(int n);                                 // Pre-allocate room for 'n' variables in total.
     int     zcount = 0;
     bool    simplify     ();                        // Removes already satisfied clauses.
     bool    solve        (const vec<Lit>& assumps); // Search for a model that respects a given set of assumptions.
@@ -72,23 +92,62 @@ public:
 
     void    toDimacs     (FILE* f, const vec<Lit>& assumps);            // Write CNF to file in DIMACS-format.
     void    toDimacs     (const char *file, const vec<Lit>& assumps);
-    void    toDimacs     (FILE* f, Clause& c, vec<Var>& map, Var& max);
+    void    toDimacs     (OutputBuffer& out, Clause& c, vec<Var>& map, Var& max);
     void    toDimacs     (const char* file);
     void    toDimacs     (const char* file, Lit p);
     void    toDimacs     (const char* file, Lit p, Lit q);
     void    toDimacs     (const char* file, Lit p, Lit q, Lit r);
-    void    toDimacsLearnt (const char* file);
+    void    toDimacsLearnt (FILE* f);                                   // Top-level facts and learnt clauses with activities.
+    void    toDimacsLearnt (const char* prefix);
+    void    toBinaryCnf  (FILE* f, const vec<Lit>& assumps);            // Same, in binary CNF format (see 'BinaryCnf.h').
+    void    toBinaryCnf  (const char* file, const vec<Lit>& assumps);
+    void    toBinaryCnf  (const char* file);
+
+    // Checkpoints (see 'Checkpoint.h'). During 'solve()', one is written to 'checkpoint_file' at the
+    // first restart after 'checkpoint_interval' seconds or after a call to 'requestCheckpoint()':
+    //
+    bool    writeCheckpoint  (const char* file);   // Save the complete state; replaces 'file' only once fully written.
+    bool    readCheckpoint   (const char* file);   // Restore into a solver without variables. A search that was saved
+                                                   // continues exactly where it stopped in the next call to 'solve()',
+                                                   // which must use the same assumptions. If FALSE, discard the solver.
+    void    requestCheckpoint();                   // Safe to call from a signal handler.
     
     //for sat-viz
     //TEMPLATE BEGIN MINISAT-VIZ DATA STRUCTURES
-    bool vizFlag;int waitingThreads;
-    sem_t   propagationDone,calculationDone;
-    vec<double> timestamps,decisionVector,unitPropsVector,conflictVector,clauseVariableRatioVector;
-    vec<double> clauseDBVector,gcEventsVector,restartEventsVector,learntClausesVector;
-    vec<double> threadedTimestamp;
+    bool vizFlag;
+    bool vizEnabled() const { return viz_build && vizFlag; }
+    bool trackClauseVarRatio;           // Recompute the unsatisfied-clause/free-variable ratio at every restart.
+
+    // Events at which a sample is queued for 'popSample()' (the latest snapshot is always available
+    // through 'readSnapshot()', e.g. for sampling on wall-clock time). A final sample is always queued
+    // when 'solve_()' returns:
+    int  sampleConflicts;               // Every this many conflicts (0 = never).
+    bool sampleRestarts;                // At every restart.
+    bool sampleReduceDB;                // After every clause database reduction.
+    int  activityTopK;                  // Number of most active variables averaged in 'Snapshot::avg_topk_activity'.
+    double conflictStatsAlpha;          // Smoothing factor of the per-conflict moving averages below.
     double gcEvents;
-    VMap<bool> seenx;
-    std::mutex mtx;
+
+    // Search statistics as seen from outside the solving thread. The solving thread publishes them
+    // at every conflict and at the sampling events above; other threads must only use
+    // 'readSnapshot()' and 'popSample()' and never read the counters directly.
+    struct Snapshot {
+        double   time;                  // Wall-clock seconds since the first call to 'solve_()'.
+        uint64_t decisions, propagations, conflicts, restarts;
+        uint64_t num_clauses, num_learnts, learnts_literals;
+        uint64_t gc_events;
+        uint64_t mem_used;              // Estimated bytes used by the clause database and per-variable data.
+        uint64_t shared_exported, shared_imported, shared_useful;
+        double   clause_var_ratio;      // As of the last restart (0 until 'trackClauseVarRatio' takes effect).
+        double   avg_lbd;               // Moving average of the LBD of learnt clauses.
+        double   backjump_distance;     // Moving average of the number of levels undone by each conflict.
+        double   conflict_level;        // Moving average of the decision level at which conflicts occur.
+        double   avg_topk_activity;     // Mean activity of the 'activityTopK' best branching candidates, as a
+                                        // multiple of the current bump amount (as of the last restart).
+    };
+    void    readSnapshot (Snapshot& s) const { statsSnapshot.read(s); }
+    bool    popSample    (Snapshot& s)       { return samples.pop(s); } // Single consumer only.
+    uint64_t droppedSamples()          const { return samples.dropped(); }
     //TEMPLATE END MINISAT-VIZ DATA STRUCTURES
 
     
@@ -112,13 +171,17 @@ public:
     double  averageActivity;
     void    setConfBudget(int64_t x);
     void    setPropBudget(int64_t x);
+    void    setCpuBudget (double secs);    // CPU-time of the calling thread, from now. Call it from the solving thread.
+    void    setMemBudget (uint64_t bytes); // Limit on 'memUsedEstimate()'.
     void    budgetOff();
+    uint64_t memUsedEstimate() const;      // Bytes used by the clause database, watcher lists and per-variable data.
+    void    setClauseExchange(ClauseExchange* x, int id); // Share learnt clauses with the other participants of 'x' (NULL = off).
     void    interrupt();          // Trigger a (potentially asynchronous) interruption of the solver.
     void    clearInterrupt();     // Clear interrupt indicator flag.
     virtual void garbageCollect();
     void    checkGarbage(double gf);
     void    checkGarbage();
-    bool    solved = false;
+    std::atomic<bool> solved{false};
     VMap<bool> firstClauseVariables;
     void       bindFirstClauseVariables(vec<Lit>& lit);
     vec<lbool> model;             // If problem is satisfiable, this vector contains the model (if any).
@@ -135,6 +198,8 @@ public:
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
     int       min_learnts_lim;    // Minimum number to set the learnts limit to.
+    const char* checkpoint_file;  // Where 'solve()' writes checkpoints (NULL = never).
+    double    checkpoint_interval;// Wall-clock seconds between checkpoints during 'solve()' (0 = only on request).
 
     int       restart_first;      // The initial restart limit.                                                                (default 100)
     double    restart_inc;        // The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
@@ -148,7 +213,7 @@ public:
     Lit       fetchFirstClauseLiterals(int idx);
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
     uint64_t dec_vars, num_clauses, num_learnts, clauses_literals, learnts_literals, max_literals, tot_literals,curr_restarts;
-    void   get_clause_variable_ratio();
+    uint64_t shared_exported, shared_imported, shared_useful, shared_lost; // Clause exchange (see 'setClauseExchange()').
 
 protected:
 
@@ -169,6 +234,10 @@ protected:
         bool operator()(const Watcher& w) const { return ca[w.cref].mark() == 1; }
     };
 
+    // All watch lists of one kind share a few large arenas (see 'ArenaOccLists'):
+    typedef ArenaOccLists<Lit, Watcher, WatcherDeleted, MkIndexLit> WatchLists;
+    typedef WatchLists::Vec                                          WatchList;
+
     struct VarOrderLt {
         const IntMap<Var, double>&  activity;
         bool operator () (Var x, Var y) const { return activity[x] > activity[y]; }
@@ -190,11 +259,14 @@ protected:
 
     VMap<double>        activity;         // A heuristic measurement of the activity of a variable.
     VMap<lbool>         assigns;          // The current assignments.
+    LMap<int8_t>        lit_value;        // The same by literal: 1 if true, -1 if false, 0 if unassigned. Read by 'propagate()'.
     VMap<char>          polarity;         // The preferred polarity of each variable.
     VMap<lbool>         user_pol;         // The users preferred polarity of each variable.
     VMap<char>          decision;         // Declares if a variable is eligible for selection in the decision heuristic.
     VMap<VarData>       vardata;          // Stores reason and level for each variable.
-    OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit> watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    WatchLists          watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    WatchLists          watches_bin;      // Same for binary clauses, which are only here. The blocker is the
+                                          // other literal, i.e. the one implied when 'lit' becomes true.
 
     FILE *logFile;
     FILE *outputFile;
@@ -221,6 +293,25 @@ protected:
     vec<ShrinkStackElem>    analyze_stack;
     vec<Lit>                analyze_toclear;
     vec<Lit>                add_tmp;
+    vec<Var>                ratio_toclear;
+    vec<uint32_t>           lbd_stamp;        // Indexed by decision level; see 'updateConflictStats()'.
+    uint32_t                lbd_counter;
+    vec<int>                topk_frontier;
+
+    // Cross-thread statistics (see 'Snapshot'):
+    //
+    SeqLock<Snapshot>       statsSnapshot;    // Latest statistics, overwritten at every conflict.
+    LockFreeQueue<Snapshot> samples;          // Event samples (see 'sampleConflicts' etc); dropped when the consumer lags behind.
+    double                  vizStartTime;     // Wall-clock origin of 'Snapshot::time'.
+    double                  clause_var_ratio; // Last value computed by 'clauseVariableRatio()'.
+    double                  ema_lbd, ema_backjump, ema_conflict_level;
+    double                  avg_topk_activity;
+
+    // Clause exchange:
+    //
+    ClauseExchange*         exchange;         // NULL if not sharing.
+    int                     exchange_id;      // Index of this solver among the participants.
+    vec<Lit>                import_tmp;
     
 
 
@@ -231,7 +322,21 @@ protected:
     //
     int64_t             conflict_budget;    // -1 means no budget.
     int64_t             propagation_budget; // -1 means no budget.
-    bool                asynch_interrupt;
+    double              cpu_budget;         // Thread CPU-time at which to stop; negative means no budget.
+    uint64_t            mem_budget;         // 0 means no budget.
+    mutable uint64_t    next_resource_check;// Value of 'propagations' at which the two budgets above are checked next.
+    std::atomic<bool>   asynch_interrupt;   // Set by 'interrupt()', possibly from another thread.
+
+    // Checkpoints:
+    //
+    volatile sig_atomic_t checkpoint_requested; // Set by 'requestCheckpoint()', possibly from a signal handler.
+    double              next_checkpoint;    // Wall-clock time of the next periodic checkpoint.
+    bool                solving;            // Inside the restart loop of 'solve_()'.
+    bool                resuming;           // A search in progress was restored; 'solve_()' continues it.
+
+    virtual bool saveState(CheckpointWriter& out); // Each class in the hierarchy saves and restores its own section
+    virtual bool loadState(CheckpointReader& in);  // after that of its base class.
+    bool         validState() const;               // Range-checks the references restored by 'loadState()'.
 
     // Main internal methods:
     //
@@ -273,9 +378,20 @@ protected:
     int      decisionLevel    ()      const; // Gives the current decisionlevel.
     uint32_t abstractLevel    (Var x) const; // Used to represent an abstraction of sets of decision levels.
     CRef     reason           (Var x) const;
+    const Lit* reasonLits     (Lit p, Lit* bin, int& size) const; // The clause that implied 'p', with 'p' first. Binary reasons are
+                                                                  // spelled out in 'bin' (two elements).
     int      level            (Var x) const;
     double   progressEstimate ()      const; // DELETE THIS ?? IT'S NOT VERY USEFUL ...
+    void     publishSnapshot  (bool sample = false);  // Make the current statistics visible to other threads; if 'sample'
+                                                      // is set, also queue them as a sample.
+    double   clauseVariableRatio();                   // Unsatisfied original clauses per unassigned variable occurring in them.
+    int      computeLBD       (const vec<Lit>& c);    // Distinct decision levels in 'c'. Levels must still be valid.
+    void     updateConflictStats(const vec<Lit>& learnt, int backtrack_level); // Before backtracking from a conflict.
+    void     exportClause     (const vec<Lit>& learnt); // Before backtracking from a conflict.
+    bool     importClauses    ();                     // At decision level 0. Returns FALSE if the problem became UNSAT.
+    double   topKActivity     (int k);                // Mean activity of the 'k' most active variables in 'order_heap'.
     bool     withinBudget     ()      const;
+    bool     withinResourceBudget()   const; // Checks CPU-time and memory; see 'next_resource_check'.
     void     relocAll         (ClauseAllocator& to);
 
 
@@ -300,6 +416,16 @@ protected:
 
 inline CRef Solver::reason(Var x) const { return vardata[x].reason; }
 inline int  Solver::level (Var x) const { return vardata[x].level; }
+inline const Lit* Solver::reasonLits(Lit p, Lit* bin, int& size) const {
+    CRef r = reason(var(p));
+    if (isBinReason(r)){
+        bin[0] = p;
+        bin[1] = binReasonLit(r);
+        size   = 2;
+        return bin; }
+    const Clause& c = ca[r];
+    size = c.size();
+    return (const Lit*)c; }
 
 inline void Solver::insertVarOrder(Var x) {
     if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
@@ -328,9 +454,13 @@ inline void Solver::claBumpActivity (Clause& c) {
 inline void Solver::checkGarbage(void){ return checkGarbage(garbage_frac); }
 inline void Solver::checkGarbage(double gf){
     if (ca.wasted() > ca.size() * gf){
-        garbageCollect(); 
+        garbageCollect();       // (Compacts the watch lists too, see 'relocAll()'.)
         gcEvents++;
     }
+    else if (watches.wasted() + watches_bin.wasted() > (watches.size() + watches_bin.size()) * gf){
+        watches    .compact();
+        watches_bin.compact();
+    }
 }
 
 // NOTE: enqueue does not set the ok flag! (only public methods do)
@@ -343,7 +473,9 @@ inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r, Lit s){ add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); add_tmp.push(s); return addClause_(add_tmp); }
 
 inline bool     Solver::isRemoved       (CRef cr)         const { return ca[cr].mark() == 1; }
-inline bool     Solver::locked          (const Clause& c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c; }
+inline bool     Solver::locked          (const Clause& c) const {
+    CRef r = reason(var(c[0]));     // (Binary clauses are never locked, see 'isBinReason()'.)
+    return value(c[0]) == l_True && r != CRef_Undef && !isBinReason(r) && ca.lea(r) == &c; }
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
@@ -369,13 +501,17 @@ inline void     Solver::setDecisionVar(Var v, bool b)
 }
 inline void     Solver::setConfBudget(int64_t x){ conflict_budget    = conflicts    + x; }
 inline void     Solver::setPropBudget(int64_t x){ propagation_budget = propagations + x; }
-inline void     Solver::interrupt(){ asynch_interrupt = true; }
-inline void     Solver::clearInterrupt(){ asynch_interrupt = false; }
-inline void     Solver::budgetOff(){ conflict_budget = propagation_budget = -1; }
+inline void     Solver::interrupt(){ asynch_interrupt.store(true, std::memory_order_relaxed); }
+inline void     Solver::clearInterrupt(){ asynch_interrupt.store(false, std::memory_order_relaxed); }
+inline void     Solver::requestCheckpoint(){ checkpoint_requested = 1; }
+inline void     Solver::setCpuBudget(double secs){ cpu_budget = threadCpuTime() + secs; next_resource_check = propagations; }
+inline void     Solver::setMemBudget(uint64_t bytes){ mem_budget = bytes; next_resource_check = propagations; }
+inline void     Solver::budgetOff(){ conflict_budget = propagation_budget = -1; cpu_budget = -1; mem_budget = 0; next_resource_check = UINT64_MAX; }
 inline bool     Solver::withinBudget() const {
-    return !asynch_interrupt &&
+    return !asynch_interrupt.load(std::memory_order_relaxed) &&
            (conflict_budget    < 0 || conflicts < (uint64_t)conflict_budget) &&
-           (propagation_budget < 0 || propagations < (uint64_t)propagation_budget); }
+           (propagation_budget < 0 || propagations < (uint64_t)propagation_budget) &&
+           (propagations < next_resource_check || withinResourceBudget()); }
 
 // FIXME: after the introduction of asynchronous interrruptions the solve-versions that return a
 // pure bool do not give a safe interface. Either interrupts must be possible to turn off here, or
@@ -396,6 +532,7 @@ inline void     Solver::toDimacs     (const char* file){ vec<Lit> as; toDimacs(f
 inline void     Solver::toDimacs     (const char* file, Lit p){ vec<Lit> as; as.push(p); toDimacs(file, as); }
 inline void     Solver::toDimacs     (const char* file, Lit p, Lit q){ vec<Lit> as; as.push(p); as.push(q); toDimacs(file, as); }
 inline void     Solver::toDimacs     (const char* file, Lit p, Lit q, Lit r){ vec<Lit> as; as.push(p); as.push(q); as.push(r); toDimacs(file, as); }
+inline void     Solver::toBinaryCnf  (const char* file){ vec<Lit> as; toBinaryCnf(file, as); }
 
 //=================================================================================================
 // Debug etc:
@@ -23,6 +23,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Minisat_SolverTypes_h
 
 #include <assert.h>
+#include <string.h>
 
 #include "minisat/mtl/IntTypes.h"
 #include "minisat/mtl/Alg.h"
@@ -84,6 +85,16 @@ template<class T> class VMap : public IntMap<Var, T>{};
 template<class T> class LMap : public IntMap<Lit, T, MkIndexLit>{};
 class LSet : public IntSet<Lit, MkIndexLit>{};
 
+// Read-only view of 'n' consecutive literals, e.g. one clause of a flat literal buffer:
+class LitSpan {
+    const Lit* lits;
+    int        n;
+public:
+    LitSpan(const Lit* l, int size) : lits(l), n(size) {}
+    int        size      ()      const { return n; }
+    const Lit& operator[](int i) const { return lits[i]; }
+};
+
 //=================================================================================================
 // Lifted booleans:
 //
@@ -140,17 +151,26 @@ class Clause;
 typedef RegionAllocator<uint32_t>::Ref CRef;
 
 class Clause {
+    // 'size' has 25 bits, so a clause holds at most 'max_size' literals ('ClauseAllocator::alloc()'
+    // throws 'OutOfMemoryException' for longer ones):
     //TEMPLATE BEGIN MINISAT_CLAUSE_DEFINITION
-    struct {unsigned mark:2;unsigned learnt:1;unsigned has_extra:1;unsigned reloced:1;unsigned size:27;} header;
+    struct {unsigned mark:2;unsigned learnt:1;unsigned has_extra:1;unsigned reloced:1;unsigned imported:1;unsigned has_pos:1;unsigned size:25;} header;
     //TEMPLATE END MINISAT_CLAUSE_DEFINITION
     union { Lit lit; float act; uint32_t abs; CRef rel; } data[0];
     friend class ClauseAllocator;
 
-    Clause(const vec<Lit>& ps, bool use_extra, bool learnt) {
+public:
+    enum { max_size = (1 << 25) - 1 };
+
+private:
+    template<class Lits>
+    Clause(const Lits& ps, bool use_extra, bool learnt) {
         header.mark      = 0;
         header.learnt    = learnt;
         header.has_extra = use_extra;
         header.reloced   = 0;
+        header.imported  = 0;
+        header.has_pos   = hasPos(ps.size());
         header.size      = ps.size();
 
         for (int i = 0; i < ps.size(); i++) 
@@ -160,6 +180,7 @@ class Clause {
             if (header.learnt) data[header.size].act = 0;
             else calcAbstraction();
         }
+        if (header.has_pos) searchPos() = 2;
     }
 
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
@@ -176,9 +197,15 @@ class Clause {
             else 
                 data[header.size].abs = from.data[header.size].abs;
         }
+        if (header.has_pos) searchPos() = from.data[from.header.size + from.header.has_extra].abs;
     }
 
 public:
+    // Clauses this long remember where 'Solver::propagate()' last found a literal to watch (see
+    // 'searchPos()'), in one more word after the extra field:
+    enum { pos_min_size = 16 };
+    static bool hasPos(int size) { return size >= pos_min_size; }
+
     void calcAbstraction() {
         assert(header.has_extra);
         uint32_t abstraction = 0;
@@ -188,13 +215,21 @@ public:
 
 
     int          size        ()      const   { return header.size; }
-    void         shrink      (int i)         { assert(i <= size()); if (header.has_extra) data[header.size-i] = data[header.size]; header.size -= i; }
+    void         shrink      (int i)         {
+        assert(i <= size());
+        uint32_t pos = header.has_pos ? searchPos() : 0;
+        if (header.has_extra) data[header.size-i] = data[header.size];
+        header.size -= i;
+        if (header.has_pos) searchPos() = pos < header.size ? pos : 2; }
     void         pop         ()              { shrink(1); }
     bool         learnt      ()      const   { return header.learnt; }
     bool         has_extra   ()      const   { return header.has_extra; }
+    bool         has_pos     ()      const   { return header.has_pos; }
     uint32_t     mark        ()      const   { return header.mark; }
     void         mark        (uint32_t m)    { header.mark = m; }
     const Lit&   last        ()      const   { return data[header.size-1].lit; }
+    bool         imported    ()      const   { return header.imported; }  // Received from another solver and not yet used in a conflict.
+    void         imported    (bool b)        { header.imported = b; }
 
     bool         reloced     ()      const   { return header.reloced; }
     CRef         relocation  ()      const   { return data[0].rel; }
@@ -208,6 +243,8 @@ public:
 
     float&       activity    ()              { assert(header.has_extra); return data[header.size].act; }
     uint32_t     abstraction () const        { assert(header.has_extra); return data[header.size].abs; }
+    uint32_t&    searchPos   ()              { assert(header.has_pos); return data[header.size + header.has_extra].abs; }
+    uint32_t     searchPos   ()      const   { assert(header.has_pos); return data[header.size + header.has_extra].abs; }
 
     Lit          subsumes    (const Clause& other) const;
     void         strengthen  (Lit p);
@@ -218,12 +255,21 @@ public:
 // ClauseAllocator -- a simple class for allocating memory for clauses:
 
 const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
+
+// The reason for a literal implied by a binary clause is not a reference to the clause but its
+// other literal, marked by the top bit, so that neither propagation nor conflict analysis has to
+// read the clause. Clause references therefore stay below 'CRef_Bin':
+const CRef CRef_Bin = 0x80000000u;
+inline CRef mkBinReason (Lit p)  { return CRef_Bin | (CRef)toInt(p); }
+inline bool isBinReason (CRef r) { return r != CRef_Undef && (r & CRef_Bin) != 0; }
+inline Lit  binReasonLit(CRef r) { return toLit((int)(r & ~CRef_Bin)); }
+
 class ClauseAllocator
 {
     RegionAllocator<uint32_t> ra;
 
-    static uint32_t clauseWord32Size(int size, bool has_extra){
-        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra))) / sizeof(uint32_t); }
+    static uint32_t clauseWord32Size(int size, bool has_extra, bool has_pos = false){
+        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra + (int)has_pos))) / sizeof(uint32_t); }
 
  public:
     enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
@@ -237,12 +283,15 @@ class ClauseAllocator
         to.extra_clause_field = extra_clause_field;
         ra.moveTo(to.ra); }
 
-    CRef alloc(const vec<Lit>& ps, bool learnt = false)
+    template<class Lits>
+    CRef alloc(const Lits& ps, bool learnt = false)
     {
         assert(sizeof(Lit)      == sizeof(uint32_t));
         assert(sizeof(float)    == sizeof(uint32_t));
+        if (ps.size() > Clause::max_size) throw OutOfMemoryException();
         bool use_extra = learnt | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra));
+        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra, Clause::hasPos(ps.size())));
+        if (cid >= CRef_Bin) throw OutOfMemoryException();
         new (lea(cid)) Clause(ps, use_extra, learnt);
 
         return cid;
@@ -250,7 +299,8 @@ class ClauseAllocator
 
     CRef alloc(const Clause& from){
         bool use_extra = from.learnt() | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra));
+        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra, from.has_pos()));
+        if (cid >= CRef_Bin) throw OutOfMemoryException();
         new (lea(cid)) Clause(from, use_extra);
         return cid; 
     }
@@ -258,6 +308,26 @@ class ClauseAllocator
     uint32_t size      () const      { return ra.size(); }
     uint32_t wasted    () const      { return ra.wasted(); }
 
+    // Raw memory image (see 'RegionAllocator::data()'):
+    const uint32_t* data   () const  { return ra.data(); }
+    uint32_t*       restore(uint32_t size, uint32_t wasted) { return ra.restore(size, wasted); }
+
+    // Whether 'r' can be the reference of a clause that lies entirely inside the region (for
+    // checking restored images; says nothing about the literals):
+    bool validRef(CRef r) const {
+        if (r >= ra.size() || ra.size() - r < clauseWord32Size(0, false)) return false;
+        const Clause& c = (const Clause&)ra[r];
+        // (A clause that shrank below 'pos_min_size' keeps its search position.)
+        return (!Clause::hasPos(c.size()) || c.has_pos())
+            && (c.has_extra() || (!c.learnt() && !extra_clause_field))
+            && ra.size() - r >= clauseWord32Size(c.size(), c.has_extra(), c.has_pos())
+            && (!c.has_pos() || (c.searchPos() >= 2 && c.searchPos() <= (uint32_t)c.size())); }
+
+    // Room for 'clauses' more problem clauses with 'lits' literals in total:
+    void reserve(int clauses, int lits){
+        uint64_t need = (uint64_t)ra.size() + (uint64_t)clauses * clauseWord32Size(0, extra_clause_field) + lits;
+        ra.reserve(need < UINT32_MAX ? (uint32_t)need : UINT32_MAX); }
+
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
     Clause&       operator[](CRef r)         { return (Clause&)ra[r]; }
     const Clause& operator[](CRef r) const   { return (Clause&)ra[r]; }
@@ -268,7 +338,7 @@ class ClauseAllocator
     void free(CRef cid)
     {
         Clause& c = operator[](cid);
-        ra.free(clauseWord32Size(c.size(), c.has_extra()));
+        ra.free(clauseWord32Size(c.size(), c.has_extra(), c.has_pos()));
     }
 
     void reloc(CRef& cr, ClauseAllocator& to)
@@ -331,6 +401,7 @@ class OccLists
         deleted(d){}
     
     void  init      (const K& idx){ occs.reserve(idx); occs[idx].clear(); dirty.reserve(idx, 0); }
+    void  capacity  (const K& idx){ occs.capacity(idx); dirty.capacity(idx); }
     Vec&  operator[](const K& idx){ return occs[idx]; }
     Vec&  lookup    (const K& idx){ if (dirty[idx]) clean(idx); return occs[idx]; }
 
@@ -375,6 +446,209 @@ void OccLists<K,Vec,Deleted,MkIndex>::clean(const K& idx)
 }
 
 
+//=================================================================================================
+// ArenaOccLists -- the same as 'OccLists', with all lists packed into a few large arenas:
+//
+// Lists are carved out of big chunks with a bump pointer. A full list grows in place if it is the
+// last one carved out of the newest chunk, and moves to the top of the newest chunk (with twice the
+// room) otherwise. The space it leaves behind counts as 'wasted()' and is only reclaimed by
+// 'compact()', which copies all lists, in key order, into one fresh chunk. Chunks never move, so growing one list does not
+// invalidate pointers into another, just like with separate vectors. Elements must be trivially
+// copyable.
+
+template<class T>
+class ListArena {
+    vec<T*>   chunks;
+    T*        top;          // First free element of the newest chunk.
+    T*        limit;        // End of the newest chunk.
+    uint64_t  allocated;    // Elements in all chunks.
+    uint64_t  freed;        // Elements given back by moved or disposed lists, or lost at chunk ends.
+
+    enum { min_chunk = 1 << 16, max_chunk = 1 << 24 };
+
+    void newChunk(uint64_t n){
+        uint64_t m = allocated / 2;                     // (The total grows by half, up to 'max_chunk'.)
+        if (m > max_chunk) m = max_chunk;
+        if (m < min_chunk) m = min_chunk;
+        if (m < n)         m = n;
+        freed     += (uint64_t)(limit - top);           // (The tail of the old chunk is lost.)
+        chunks.push((T*)xrealloc(NULL, sizeof(T) * m));
+        top        = chunks.last();
+        limit      = top + m;
+        allocated += m; }
+
+    // Don't allow copying:
+    ListArena(const ListArena&);
+    ListArena& operator=(const ListArena&);
+
+ public:
+    ListArena() : top(NULL), limit(NULL), allocated(0), freed(0) {}
+    ~ListArena() { clear(); }
+
+    void reserve(uint64_t n){ if ((uint64_t)(limit - top) < n) newChunk(n); }   // Room for 'n' more in the newest chunk.
+    T*   alloc  (uint32_t n){ reserve(n); T* p = top; top += n; return p; }
+    bool extend (const T* end, uint32_t n){     // Grow the allocation ending at 'end', if it is the last one.
+        if (end != top || (uint64_t)(limit - top) < n) return false;
+        top += n;
+        return true; }
+    void free   (uint32_t n){ freed += n; }
+
+    uint64_t size  () const { return allocated; }
+    uint64_t wasted() const { return freed; }     // (The rest of the newest chunk is still usable.)
+
+    void clear(){
+        for (int i = 0; i < chunks.size(); i++) ::free(chunks[i]);
+        chunks.clear(true);
+        top = limit = NULL;
+        allocated = freed = 0; }
+
+    void moveTo(ListArena& to){
+        to.clear();
+        chunks.moveTo(to.chunks);
+        to.top = top; to.limit = limit; to.allocated = allocated; to.freed = freed;
+        top = limit = NULL;
+        allocated = freed = 0; }
+};
+
+
+template<class T>
+class ArenaVec {
+    T*            data;
+    uint32_t      sz;
+    uint32_t      cap   : 31;
+    uint32_t      dirty : 1;    // (Kept here for 'ArenaOccLists', so a lookup reads one header.)
+    ListArena<T>* arena;
+
+    template<class K, class E, class Deleted, class MkIndex> friend class ArenaOccLists;
+
+    void grow(uint32_t min_cap){
+        uint32_t c   = cap;
+        uint32_t add = min_cap - c > c + 2 ? min_cap - c : c + 2;
+        if (data != NULL && arena->extend(data + c, add)){ cap = c + add; return; }
+        T* d = arena->alloc(c + add);
+        if (sz > 0) memcpy(d, data, sizeof(T) * sz);
+        arena->free(c);
+        data = d;
+        cap  = c + add; }
+
+ public:
+    ArenaVec() : data(NULL), sz(0), cap(0), dirty(0), arena(NULL) {}
+
+    int      size      () const         { return sz; }
+    operator T*        ()               { return data; }
+    operator const T*  () const         { return data; }
+    T&       operator[](int i)          { return data[i]; }
+    const T& operator[](int i) const    { return data[i]; }
+    T&       last      ()               { return data[sz-1]; }
+
+    void     push      (const T& x)     { if (sz == cap) grow(sz+1); data[sz++] = x; }
+    void     pop       ()               { assert(sz > 0); sz--; }
+    void     shrink    (int n)          { assert(n <= (int)sz); sz -= n; }
+    void     capacity  (int n)          { if ((uint32_t)n > cap) grow(n); }
+    void     growTo    (int n, const T& pad){ capacity(n); for (int i = sz; i < n; i++) data[i] = pad; if (n > (int)sz) sz = n; }
+    void     clear     (bool dispose = false){
+        sz = 0;
+        if (dispose && data != NULL){
+            arena->free(cap);
+            data = NULL;
+            cap  = 0; } }
+};
+
+
+template<class K, class T, class Deleted, class MkIndex = MkIndexDefault<K> >
+class ArenaOccLists
+{
+    ListArena<T>                    arena;
+    IntMap<K, ArenaVec<T>, MkIndex> occs;
+    vec<K>                          dirties;
+    Deleted                         deleted;
+
+    static uint32_t roomFor(uint32_t size) { return size + (size >> 1) + 2; }
+
+    // Don't allow copying (the lists point to 'arena'):
+    ArenaOccLists(const ArenaOccLists&);
+    ArenaOccLists& operator=(const ArenaOccLists&);
+
+ public:
+    typedef ArenaVec<T> Vec;
+
+    ArenaOccLists(const Deleted& d, MkIndex _index = MkIndex()) :
+        occs(_index), 
+        deleted(d){}
+    
+    void  init      (const K& idx){ occs.reserve(idx); occs[idx].clear(true); occs[idx].dirty = 0; occs[idx].arena = &arena; }
+    void  capacity  (const K& idx){ occs.capacity(idx); }
+    Vec&  operator[](const K& idx){ return occs[idx]; }
+    const Vec& operator[](const K& idx) const { return occs[idx]; }
+    Vec&  lookup    (const K& idx){ Vec& v = occs[idx]; if (v.dirty) clean(idx); return v; }
+
+    void  cleanAll  ();
+    void  clean     (const K& idx);
+    void  smudge    (const K& idx){
+        if (occs[idx].dirty == 0){
+            occs[idx].dirty = 1;
+            dirties.push(idx);
+        }
+    }
+
+    // Copies all lists into one new chunk, leaving each some room to grow. Invalidates all pointers
+    // into the lists:
+    void  compact   ();
+    uint64_t size   () const { return arena.size(); }       // In elements, including unused ones.
+    uint64_t wasted () const { return arena.wasted(); }
+
+    void  clear(bool free = true){
+        occs   .clear(free);
+        dirties.clear(free);
+        arena  .clear();
+    }
+};
+
+
+template<class K, class T, class Deleted, class MkIndex>
+void ArenaOccLists<K,T,Deleted,MkIndex>::cleanAll()
+{
+    for (int i = 0; i < dirties.size(); i++)
+        // Dirties may contain duplicates so check here if a variable is already cleaned:
+        if (occs[dirties[i]].dirty)
+            clean(dirties[i]);
+    dirties.clear();
+}
+
+
+template<class K, class T, class Deleted, class MkIndex>
+void ArenaOccLists<K,T,Deleted,MkIndex>::clean(const K& idx)
+{
+    Vec& vec = occs[idx];
+    int  i, j;
+    for (i = j = 0; i < vec.size(); i++)
+        if (!deleted(vec[i]))
+            vec[j++] = vec[i];
+    vec.shrink(i - j);
+    vec.dirty = 0;
+}
+
+
+template<class K, class T, class Deleted, class MkIndex>
+void ArenaOccLists<K,T,Deleted,MkIndex>::compact()
+{
+    uint64_t need = 0;
+    for (const Vec* v = occs.begin(); v != occs.end(); v++)
+        if (v->data != NULL) need += roomFor(v->sz);
+
+    ListArena<T> to;
+    to.reserve(need + need / 4);    // The rest is for lists that outgrow their room.
+    for (Vec* v = occs.begin(); v != occs.end(); v++)
+        if (v->data != NULL){
+            uint32_t cap = roomFor(v->sz);
+            T*       d   = to.alloc(cap);
+            if (v->sz > 0) memcpy(d, v->data, sizeof(T) * v->sz);
+            v->data = d;
+            v->cap  = cap; }
+    to.moveTo(arena);
+}
+
+
 //=================================================================================================
 // CMap -- a class for mapping clauses to values:
 
@@ -0,0 +1,76 @@
+/************************************************************************************[VizMetrics.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_VizMetrics_h
+#define Minisat_VizMetrics_h
+
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Metrics understood by the visualizer. The ids are stored in metric streams, so only ever append
+// to this list. The names double as the keys of the "metrics" section in 'config.json'.
+
+enum VizMetric {
+    metric_decisions         = 0,
+    metric_propagations      = 1,
+    metric_conflicts         = 2,
+    metric_clause_db_size    = 3,
+    metric_gc_events         = 4,
+    metric_learnt_clauses    = 5,
+    metric_restarts          = 6,
+    metric_clause_var_ratio  = 7,
+    metric_avg_lbd           = 8,
+    metric_backjump_distance = 9,
+    metric_conflict_level    = 10,
+    metric_avg_topk_activity = 11,
+    metric_clause_var_ratio_vector = 12,
+
+    num_viz_metrics          = 13,
+    num_plotted_metrics      = 12   // Metrics below this id are currently recorded and plotted.
+};
+
+static const char* const viz_metric_names[num_viz_metrics] = {
+    "nDecisions", "nUnitProps", "nConflicts", "clauseDatabaseSize", "gcEvents", "learnt_clause_count",
+    "restartEvents", "clause_variable_ratio", "avg_lbd", "backjumpDistance", "conflictDecisionLevel",
+    "avgTopKActivity", "clauseVariableRatioVector" };
+
+// Value of a plotted metric in a published snapshot:
+static inline double vizMetricValue(const Solver::Snapshot& s, int metric)
+{
+    switch (metric){
+    case metric_decisions:         return (double)s.decisions;
+    case metric_propagations:      return (double)s.propagations;
+    case metric_conflicts:         return (double)s.conflicts;
+    case metric_clause_db_size:    return (double)s.num_clauses + (double)s.num_learnts;
+    case metric_gc_events:         return (double)s.gc_events;
+    case metric_learnt_clauses:    return (double)s.num_learnts;
+    case metric_restarts:          return (double)s.restarts;
+    case metric_clause_var_ratio:  return s.clause_var_ratio;
+    case metric_avg_lbd:           return s.avg_lbd;
+    case metric_backjump_distance: return s.backjump_distance;
+    case metric_conflict_level:    return s.conflict_level;
+    case metric_avg_topk_activity: return s.avg_topk_activity;
+    default:                       return 0;
+    }
+}
+
+//=================================================================================================
+}
+
+#endif
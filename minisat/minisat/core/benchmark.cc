@@ -0,0 +1,334 @@
+/**************************************************************************************[benchmark.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Throughput benchmark: solves each input under a conflict budget and reports propagations and
+// conflicts per second. Built twice, as 'minisat_bench' (plain solver) and 'minisat_bench_viz'
+// (instrumented solver), so the cost of the visualizer hooks can be measured on the same inputs.
+// With '-parse' it instead compares the DIMACS readers (zlib stream vs. memory-mapped), and with
+// '-propagate' it measures 'propagate()' alone, and '-series' checks the downsampling of the plotted
+// series (no input needed). With '-baseline=<binary>' another 'minisat_core' (e.g. one built from
+// upstream MiniSat) solves the same inputs, and its rate is reported next to ours. Comparing builds with and without the CMake option
+// 'MINISAT_PREFETCH' on large inputs shows what clause prefetching gains.
+
+#include <errno.h>
+#include <zlib.h>
+#include <sys/stat.h>
+
+#include "minisat/mtl/BoundedSeries.h"
+#include "minisat/utils/System.h"
+#include "minisat/utils/ParseUtils.h"
+#include "minisat/utils/Options.h"
+#include "minisat/core/Dimacs.h"
+#include "minisat/core/Solver.h"
+
+using namespace Minisat;
+
+#ifdef MINISAT_PREFETCH
+static const char* prefetch_note = ", prefetching";
+#else
+static const char* prefetch_note = "";
+#endif
+
+//=================================================================================================
+// Parser benchmark:
+
+
+// Accepts what the parser produces without building a solver, so only the reader is measured:
+struct ParseSink {
+    int      vars;
+    uint64_t clauses, lits, hash;   // 'hash' checks that both readers produce the same clauses.
+
+    ParseSink() : vars(0), clauses(0), lits(0), hash(0) {}
+    int  nVars() const { return vars; }
+    Var  newVar()      { return vars++; }
+    void reserveVars(int) {}
+    void bindFirstClauseVariables(vec<Lit>&) {}
+    bool addClauses(vec<Lit>& ls, const vec<int>& offsets) {
+        clauses += offsets.size() - 1;
+        lits    += ls.size();
+        for (int i = 0; i < ls.size(); i++) hash = hash * 1000003 + toInt(ls[i]);
+        return true; }
+};
+
+
+static double parseStream(const char* path, ParseSink& sink)
+{
+    double start = realTime();
+    gzFile in = gzopen(path, "rb");
+    if (in == NULL)
+        fprintf(stderr, "ERROR! Could not open file: %s\n", path), exit(1);
+    parse_DIMACS(in, sink);
+    gzclose(in);
+    return realTime() - start;
+}
+
+
+static double parseMapped(const char* path, ParseSink& sink, int threads)
+{
+    double start = realTime();
+    MappedBuffer in;
+    if (!in.open(path))
+        fprintf(stderr, "ERROR! Not an uncompressed regular file: %s\n", path), exit(1);
+    parse_DIMACS(in, sink, false, threads);
+    return realTime() - start;
+}
+
+
+// With 'threads > 1' the multi-threaded reader is measured as a third column:
+static void benchParse(int argc, char** argv, int repeat, int threads)
+{
+    printf("%-32s %10s %12s %12s", "input", "MB", "stream MB/s", "mapped MB/s");
+    if (threads > 1) printf(" %9d-thr", threads);
+    printf(" %12s %8s\n", "clauses", "speedup");
+    for (int f = 1; f < argc; f++){
+        double best_stream = -1, best_mapped = -1, best_threaded = -1;
+        ParseSink s, m, t;
+        for (int r = 0; r < repeat; r++){
+            ParseSink s1, m1, t1;
+            double ts = parseStream(argv[f], s1);
+            double tm = parseMapped(argv[f], m1, 1);
+            double tt = threads > 1 ? parseMapped(argv[f], t1, threads) : tm;
+            if (best_stream   < 0 || ts < best_stream)   best_stream   = ts;
+            if (best_mapped   < 0 || tm < best_mapped)   best_mapped   = tm;
+            if (best_threaded < 0 || tt < best_threaded) best_threaded = tt;
+            s = s1; m = m1; t = threads > 1 ? t1 : m1;
+        }
+        if (s.hash != m.hash || s.clauses != m.clauses || s.vars != m.vars
+         || t.hash != m.hash || t.clauses != m.clauses || t.vars != m.vars)
+            fprintf(stderr, "ERROR! The readers disagree on %s\n", argv[f]), exit(1);
+
+        struct stat st;
+        double mb = stat(argv[f], &st) == 0 ? st.st_size / 1048576.0 : 0;
+        const char* name = strrchr(argv[f], '/') ? strrchr(argv[f], '/') + 1 : argv[f];
+        printf("%-32s %10.1f %12.0f %12.0f", name, mb, mb / best_stream, mb / best_mapped);
+        if (threads > 1) printf(" %13.0f", mb / best_threaded);
+        printf(" %12" PRIu64 " %7.1fx\n", m.clauses, best_stream / best_threaded);
+    }
+}
+
+//=================================================================================================
+// Propagation benchmark:
+
+
+// Calls 'propagate()' after random decisions, going back to level 0 after a conflict or once 'depth'
+// levels are open. There is no conflict analysis and no learning, so the sequence of propagations
+// only depends on the input, and different builds can be compared on exactly the same work:
+class PropagateBench : public Solver {
+public:
+    uint64_t props;
+
+    double run(int decisions, int depth) {
+        double seed  = 91648253;
+        double start = realTime();
+        props = propagations;
+        for (int d = 0; d < decisions; d++){
+            if (decisionLevel() >= depth || nAssigns() == nVars()) cancelUntil(0);
+            if (nAssigns() == nVars()) break;
+            Var v = irand(seed, nVars());
+            while (value(v) != l_Undef) v = v + 1 < nVars() ? v + 1 : 0;
+            newDecisionLevel();
+            uncheckedEnqueue(mkLit(v, drand(seed) < 0.5));
+            if (propagate() != CRef_Undef) cancelUntil(0);
+        }
+        cancelUntil(0);
+        props = propagations - props;
+        return realTime() - start; }
+};
+
+
+static void benchPropagate(int argc, char** argv, int repeat, int decisions, int depth)
+{
+    printf("build: %s%s\n", viz_build ? "instrumented" : "plain", prefetch_note);
+    printf("%-32s %12s %12s %10s %14s\n", "input", "propagations", "decisions", "time(s)", "props/s");
+    for (int f = 1; f < argc; f++){
+        uint64_t props     = 0;
+        double   best_time = -1;
+        for (int r = 0; r < repeat; r++){
+            PropagateBench S;
+            S.verbosity = 0;
+            if (!parse_DIMACS(argv[f], S))
+                fprintf(stderr, "ERROR! Could not open file: %s\n", argv[f]), exit(1);
+            if (!S.simplify()){
+                fprintf(stderr, "WARNING: %s is unsatisfiable at level 0, skipped\n", argv[f]);
+                break; }
+            double elapsed = S.run(decisions, depth);
+            if (best_time < 0 || elapsed < best_time) best_time = elapsed;
+            props = S.props;
+        }
+        if (best_time < 0) continue;
+
+        const char* name = strrchr(argv[f], '/') ? strrchr(argv[f], '/') + 1 : argv[f];
+        printf("%-32s %12" PRIu64 " %12d %10.3f %14.0f\n", name, props, decisions, best_time, props / best_time);
+    }
+}
+
+//=================================================================================================
+// Baseline comparison:
+
+
+// Runs 'binary' (any MiniSat 'minisat_core') on 'path' to completion, 'repeat' times, and returns the
+// best propagation rate it reports, over its CPU time minus the parse time. Runs that print no
+// statistics (crashed or were killed) are skipped; returns 0 if there were none:
+static double baselineRate(const char* binary, const char* path, int repeat, uint64_t& confl)
+{
+    char cmd[4096];
+    snprintf(cmd, sizeof(cmd), "'%s' -verb=1 '%s' /dev/null 2>/dev/null", binary, path);
+    double best = 0;
+    for (int r = 0; r < repeat; r++){
+        FILE* out = popen(cmd, "r");
+        if (out == NULL)
+            fprintf(stderr, "ERROR! Could not run: %s\n", binary), exit(1);
+        char     line[1024];
+        uint64_t props = 0, conflicts = 0;
+        double   cpu = -1, parse = 0;
+        while (fgets(line, sizeof(line), out) != NULL){
+            sscanf(line, "propagations : %" SCNu64, &props);
+            sscanf(line, "conflicts : %" SCNu64, &conflicts);
+            sscanf(line, "CPU time : %lf", &cpu);
+            sscanf(line, "| Parse time: %lf", &parse); }
+        pclose(out);
+        if (cpu > parse && props / (cpu - parse) > best){
+            best  = props / (cpu - parse);
+            confl = conflicts; }
+    }
+    return best;
+}
+
+//=================================================================================================
+// Series check:
+
+
+// Pushes 'n' points into series of awkward capacities and checks what is left: x must stay strictly
+// increasing (a point overwritten during downsampling shows up as a repeated or misplaced x), the
+// extremes and the newest point must survive, and the capacity must hold. The y values are either
+// noisy with spikes, or rising, which makes every re-read stale point an extreme of its bucket:
+static bool checkSeries(int n)
+{
+    static const int caps[] = { 16, 30, 100, 102, 1000, 4096 };
+    bool ok = true;
+    for (int rising = 0; rising < 2; rising++)
+    for (int c = 0; c < (int)(sizeof(caps) / sizeof(caps[0])); c++){
+        BoundedSeries s(caps[c]);
+        uint64_t seed  = 91648253;
+        double   min_y = 0, max_y = 0;
+        for (int i = 0; i < n; i++){
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            double y = rising ? i : (seed >> 40) + (i % 997 == 0 ? 1e8 : 0);
+            if (i == 0 || y < min_y) min_y = y;
+            if (i == 0 || y > max_y) max_y = y;
+            s.push(i, y);
+            if (s.size() > s.capacity()) break;
+        }
+
+        const vec<double>& xs = s.times();
+        const vec<double>& ys = s.values();
+        bool has_min = false, has_max = false, sorted = true;
+        for (int i = 0; i < xs.size(); i++){
+            has_min |= ys[i] == min_y;
+            has_max |= ys[i] == max_y;
+            if (i > 0 && xs[i] <= xs[i-1]) sorted = false; }
+        const char* err = s.size() > s.capacity() ? "over capacity"
+                        : !sorted                 ? "x out of order"
+                        : xs.last() != n - 1      ? "newest point lost"
+                        : !has_min || !has_max    ? "extreme lost" : NULL;
+        printf("%-6s capacity %5d: %5d points, %s\n", rising ? "rising" : "noisy", caps[c], s.size(), err ? err : "ok");
+        ok &= err == NULL;
+    }
+    return ok;
+}
+
+//=================================================================================================
+
+
+int main(int argc, char** argv)
+{
+    setUsageHelp("USAGE: %s [options] <input-file> [<input-file> ...]\n\n  where input may be either in plain or gzipped DIMACS.\n");
+    setX86FPUPrecision();
+    IntOption    confl ("BENCH", "conflicts", "Conflict budget per run (0 = run to completion; ignored with '-baseline').", 100000, IntRange(0, INT32_MAX));
+    IntOption    repeat("BENCH", "repeat",    "Number of runs per input; the fastest one is reported.", 3, IntRange(1, INT32_MAX));
+    BoolOption   viz   ("BENCH", "viz",       "Turn on snapshot publishing (only has an effect in 'minisat_bench_viz').", false);
+    BoolOption   parse ("BENCH", "parse",     "Only compare the DIMACS readers (inputs must be uncompressed).", false);
+    IntOption    pthr  ("BENCH", "parse-threads", "Also measure the multi-threaded reader with this many threads.", 1, IntRange(1, 256));
+    BoolOption   prop  ("BENCH", "propagate", "Only measure 'propagate()', driven by random decisions.", false);
+    IntOption    decs  ("BENCH", "decisions", "Number of decisions per run with '-propagate'.", 1000000, IntRange(1, INT32_MAX));
+    IntOption    depth ("BENCH", "depth",     "Decision levels before going back to level 0 with '-propagate'.", 100, IntRange(1, INT32_MAX));
+    BoolOption   series("BENCH", "series",    "Only check the downsampling of plotted series (no input files).", false);
+    StringOption base  ("BENCH", "baseline",  "Also run this 'minisat_core' binary on each input and report its props/s (both solve to completion).");
+    parseOptions(argc, argv, true);
+
+    if (series)
+        return checkSeries(1000000) ? 0 : 1;
+
+    if (argc < 2){
+        fprintf(stderr, "ERROR! No input files given. Use '--help' for help.\n");
+        exit(1); }
+
+    if (parse){
+        benchParse(argc, argv, repeat, pthr);
+        return 0; }
+
+    if (prop){
+        benchPropagate(argc, argv, repeat, decs, depth);
+        return 0; }
+
+    printf("build: %s%s%s\n", viz_build ? "instrumented" : "plain", prefetch_note, viz_build && viz ? " (publishing)" : "");
+    printf("%-32s %12s %12s %10s %14s %12s", "input", "propagations", "conflicts", "time(s)", "props/s", "confl/s");
+    if (base) printf(" %12s %14s %8s", "base confl", "base props/s", "ratio");
+    printf("\n");
+
+    double tot_props = 0, tot_time = 0;
+    for (int f = 1; f < argc; f++){
+        uint64_t best_props = 0, best_confl = 0;
+        double   best_time  = -1;
+
+        for (int r = 0; r < repeat; r++){
+            std::string log = "/dev/null", out = "/dev/null";
+            Solver* S = viz ? new Solver(log, out) : new Solver();
+            S->verbosity = 0;
+
+            if (!parse_DIMACS(argv[f], *S))
+                fprintf(stderr, "ERROR! Could not open file: %s\n", argv[f]), exit(1);
+
+            if (confl > 0 && !base) S->setConfBudget(confl);
+            vec<Lit> dummy;
+            double start = realTime();
+            if (S->simplify()) S->solveLimited(dummy);
+            double elapsed = realTime() - start;
+
+            if (best_time < 0 || elapsed < best_time){
+                best_time  = elapsed;
+                best_props = S->propagations;
+                best_confl = S->conflicts; }
+            delete S;
+        }
+
+        const char* name = strrchr(argv[f], '/') ? strrchr(argv[f], '/') + 1 : argv[f];
+        printf("%-32s %12" PRIu64 " %12" PRIu64 " %10.3f %14.0f %12.0f", name, best_props, best_confl, best_time,
+               best_props / best_time, best_confl / best_time);
+        if (base){
+            uint64_t base_confl = 0;
+            double   base_rate  = baselineRate(base, argv[f], repeat, base_confl);
+            if (base_rate > 0) printf(" %12" PRIu64 " %14.0f %7.3fx", base_confl, base_rate, best_props / best_time / base_rate);
+            else               printf(" %12s %14s %8s", "-", "failed", "-"); }
+        printf("\n");
+        tot_props += best_props;
+        tot_time  += best_time;
+    }
+
+    printf("%-32s %12.0f %12s %10.3f %14.0f\n", "total", tot_props, "", tot_time, tot_props / tot_time);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/************************************************************************************[cnf_convert.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Converts DIMACS (plain or gzipped) to binary CNF, so instances that are solved over and over skip
+// the text parsing. Reads binary CNF too, and with '-text' writes DIMACS, which turns a binary file
+// back into the original clauses.
+
+#include <errno.h>
+#include <zlib.h>
+
+#include "minisat/utils/System.h"
+#include "minisat/utils/ParseUtils.h"
+#include "minisat/utils/Options.h"
+#include "minisat/utils/OutputBuffer.h"
+#include "minisat/core/Dimacs.h"
+#include "minisat/core/BinaryCnf.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+
+
+// Keeps the clauses exactly as read (no simplification, no variable renumbering):
+struct CnfCollector {
+    int      vars;
+    vec<Lit> lits;      // The literals of all clauses, back to back.
+    vec<int> sizes;
+
+    CnfCollector() : vars(0) {}
+    int  nVars() const { return vars; }
+    Var  newVar()      { return vars++; }
+    void reserveVars(int) {}
+    void bindFirstClauseVariables(vec<Lit>&) {}
+    bool addClauses(vec<Lit>& ls, const vec<int>& offsets) {
+        for (int i = 0; i + 1 < offsets.size(); i++) sizes.push(offsets[i+1] - offsets[i]);
+        for (int i = 0; i < ls.size(); i++) lits.push(ls[i]);
+        return true; }
+};
+
+
+int main(int argc, char** argv)
+{
+    setUsageHelp("USAGE: %s [options] <input-file> <output-file>\n\n  where input may be plain or gzipped DIMACS, or binary CNF.\n");
+    BoolOption   text("CONVERT", "text", "Write DIMACS instead of binary CNF.", false);
+    BoolOption   crc ("CONVERT", "crc",  "Store a CRC-32 checksum with every block of binary CNF.", true);
+    parseOptions(argc, argv, true);
+
+    if (argc != 3){
+        fprintf(stderr, "ERROR! Expected an input and an output file. Use '--help' for help.\n");
+        exit(1); }
+
+    double       start = realTime();
+    CnfCollector cnf;
+    if (!parse_DIMACS(argv[1], cnf))
+        fprintf(stderr, "ERROR! Could not open file: %s\n", argv[1]), exit(1);
+    double parsed = realTime();
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL)
+        fprintf(stderr, "ERROR! Could not open file: %s\n", argv[2]), exit(1);
+
+    const Lit* p = cnf.lits;
+    if (text){
+        OutputBuffer buf(out);
+        buf.put("p cnf ");
+        buf.putInt(cnf.vars);
+        buf.put(' ');
+        buf.putInt(cnf.sizes.size());
+        buf.put('\n');
+        for (int i = 0; i < cnf.sizes.size(); i++){
+            for (int j = 0; j < cnf.sizes[i]; j++, p++){
+                buf.putInt(sign(*p) ? -(var(*p) + 1) : var(*p) + 1);
+                buf.put(' '); }
+            buf.put("0\n"); }
+        if (!buf.flush())
+            fprintf(stderr, "ERROR! Could not write file: %s\n", argv[2]), exit(1);
+    }else{
+        BinaryCnfWriter writer(out, cnf.vars, cnf.sizes.size(), crc);
+        for (int i = 0; i < cnf.sizes.size(); i++){
+            writer.addClause(LitSpan(p, cnf.sizes[i]));
+            p += cnf.sizes[i]; }
+        writer.finish();
+    }
+    if (fclose(out) != 0)
+        fprintf(stderr, "ERROR! Could not write file: %s\n", argv[2]), exit(1);
+
+    printf("%d variables, %d clauses: read in %.2f s, written in %.2f s\n", cnf.vars, cnf.sizes.size(),
+           parsed - start, realTime() - parsed);
+    return 0;
+}
@@ -26,15 +26,26 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/utils/Options.h"
 #include "minisat/core/Dimacs.h"
 #include "minisat/core/Solver.h"
+#include "minisat/core/VizMetrics.h"
+#include "minisat/core/ClauseExchange.h"
+#include "minisat/utils/MetricStream.h"
+#include "minisat/utils/MetricsServer.h"
+#include "minisat/mtl/BoundedSeries.h"
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <functional>
+#include <mutex>
 #include "matplotlibcpp.h"
 #include "semaphore.h"
 #include "json.hpp"
 #include <filesystem>
 #include <fstream>
 
+#ifndef MINISAT_VIZ
+#error "The visualizer must be linked against the instrumented solver library (minisat-viz)."
+#endif
+
 using json = nlohmann::json;
 using namespace Minisat;
 using namespace std;
@@ -44,7 +55,6 @@ namespace plt = matplotlibcpp;
 
 static Solver* solver;
 
-using dataAccessorFunction = const vec<double>& (*)(const Solver* S);
 static void SIGINT_interrupt(int) { solver->interrupt(); }
 
 static void SIGINT_exit(int) {
@@ -59,9 +69,29 @@ static void SIGINT_exit(int) {
 
 
 std::atomic<bool> stopFlag(false);
-std::vector<Solver*> solvers;
 sem_t pauseSem;
 
+// Plotted history of one solver. Only the plotting thread touches the series; the solver is read
+// exclusively through its published snapshots. 'S' is set by the worker once the instance is
+// parsed and cleared (and the solver deleted) by the plotting thread after the job finished, so
+// the list of series itself is fixed up front and needs no lock.
+struct SolverSeries {
+    std::atomic<Solver*> S;
+    uint32_t id;
+    double lastTime;
+    Solver::Snapshot latest;    // Most recent sample, as exported by 'writeOpenMetrics()'.
+    BoundedSeries decisionVector,unitPropsVector,conflictVector;
+    BoundedSeries clauseDBVector,gcEventsVector,restartEventsVector,learntClausesVector,clauseVarRatioVector;
+    BoundedSeries avgLbdVector,backjumpVector,conflictLevelVector,topKActivityVector;
+    SolverSeries(uint32_t i,int cap) : S(nullptr), id(i), lastTime(-1),
+        decisionVector(cap), unitPropsVector(cap), conflictVector(cap),
+        clauseDBVector(cap), gcEventsVector(cap), restartEventsVector(cap), learntClausesVector(cap), clauseVarRatioVector(cap),
+        avgLbdVector(cap), backjumpVector(cap), conflictLevelVector(cap), topKActivityVector(cap) {}
+};
+std::vector<SolverSeries*> series;
+
+using dataAccessorFunction = const BoundedSeries& (*)(const SolverSeries* S);
+
 
 struct bounded_metrics{
     std::string metricName;
@@ -71,10 +101,16 @@ struct bounded_metrics{
 
 typedef struct bounded_metrics bounded_metric;
 struct metrics{bool flags[13];};
-vector<string> options = {"nDecisions","nUnitProps","nConflicts","clauseDatabaseSize","gcEvents","learnt_clause_count","restartEvents","clause_variable_ratio","avg_lbd","backjumpDistance","conflictDecisionLevel","avgTopKActivity","clauseVariableRatioVector"};
+vector<string> options(viz_metric_names,viz_metric_names + num_viz_metrics);
 struct metrics metric;
 volatile int active_metrics = 0;
 
+// Headless mode: samples go to a binary metric stream (rendered offline by 'metric_renderer')
+// and/or are exported for scraping, instead of being plotted in-process.
+bool headless = false;
+MetricStream metricStream;
+MetricsServer metricsServer;
+
 bool createIfNotExists(string& dir){
     if (filesystem::exists(dir)){
         if (filesystem::is_directory(dir)) return true;
@@ -97,147 +133,462 @@ void parseMetrics(json& configMetrics,bool& flag,string& option_name){
     else flag = false;
 }
 
-class ThreadPool {
-public:
-    using Task = Solver*;  
-    ThreadPool(size_t threadCount) : stop(false) {
-        workers.reserve(threadCount);
-        for (size_t i = 0; i < threadCount; i++) {
-            workers.emplace_back([this]() { workerLoop(); });
+//easy statistics minisat already tracks them
+inline void updateDecisions(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[0]) S->decisionVector.push(snap.time,snap.decisions);}
+inline void updateUnitProps(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[1]) S->unitPropsVector.push(snap.time,snap.propagations);}
+inline void updateConflictsCount(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[2]) S->conflictVector.push(snap.time,snap.conflicts);}
+inline void updateClauseDBSize(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[3]) S->clauseDBVector.push(snap.time,((double)snap.num_clauses) + ((double)snap.num_learnts));}
+inline void updateGCEvents(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[4]) S->gcEventsVector.push(snap.time,snap.gc_events);}
+inline void updateLearntClauses(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[5]) S->learntClausesVector.push(snap.time,snap.num_learnts);}
+inline void updateRestartEvents(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[6]) S->restartEventsVector.push(snap.time,snap.restarts);}
+inline void updateClauseVariableRatio(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[7]) S->clauseVarRatioVector.push(snap.time,snap.clause_var_ratio);}
+inline void updateAvgLbd(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[8]) S->avgLbdVector.push(snap.time,snap.avg_lbd);}
+inline void updateBackjumpDistance(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[9]) S->backjumpVector.push(snap.time,snap.backjump_distance);}
+inline void updateConflictLevel(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[10]) S->conflictLevelVector.push(snap.time,snap.conflict_level);}
+inline void updateTopKActivity(SolverSeries* S,const Solver::Snapshot& snap){if (metric.flags[11]) S->topKActivityVector.push(snap.time,snap.avg_topk_activity);}
+
+// Appends one sample to every enabled series. Samples must arrive in time order; anything that is
+// not newer than the last recorded point (e.g. a restart sample that was overtaken by the live
+// snapshot of the previous tick) is skipped.
+void appendSample(SolverSeries* S,const Solver::Snapshot& snap){
+    if (snap.time <= S->lastTime) return;
+    S->lastTime = snap.time;
+    S->latest = snap;
+    if (headless){
+        if (metricStream.isOpen())
+            for (int metric_no = 0; metric_no < num_plotted_metrics; metric_no++)
+                if (metric.flags[metric_no]) metricStream.append(S->id,metric_no,snap.time,vizMetricValue(snap,metric_no));
+        return;
+    }
+    updateDecisions(S,snap);
+    updateUnitProps(S,snap);
+    updateConflictsCount(S,snap);
+    updateClauseDBSize(S,snap);
+    updateGCEvents(S,snap);
+    updateLearntClauses(S,snap);
+    updateRestartEvents(S,snap);
+    updateClauseVariableRatio(S,snap);
+    updateAvgLbd(S,snap);
+    updateBackjumpDistance(S,snap);
+    updateConflictLevel(S,snap);
+    updateTopKActivity(S,snap);
+}
+
+// Sampling cadence. Solver-event sampling is configured on the solvers themselves (see
+// 'configureSampling()'); 'sampleWall' adds a sample of the latest snapshot every so many seconds
+// (0 = event samples only). 'refreshRate' is how often the plot is redrawn, or the stream flushed.
+double refreshRate = 2, sampleWall = 2;
+int sampleConflicts = 0;
+bool sampleRestarts = true, sampleReduceDB = false;
+
+void configureSampling(Solver* S){
+    S->sampleConflicts = sampleConflicts;
+    S->sampleRestarts  = sampleRestarts;
+    S->sampleReduceDB  = sampleReduceDB;
+}
+
+// Collects everything a solver published since the previous tick: the event samples from its
+// ring buffer, followed by its latest snapshot if a wall-clock sample is due. Neither read ever
+// blocks the solver.
+void collectSamples(SolverSeries* S,Solver* solver,bool wall){
+    Solver::Snapshot snap;
+    while (solver->popSample(snap)) appendSample(S,snap);
+    if (!wall) return;
+    solver->readSnapshot(snap);
+    appendSample(S,snap);
+}
+
+// Held while a finished solver is retired, and by anyone else who dereferences 'SolverSeries::S'
+// from outside the sampling thread (see 'finishPortfolioJob()').
+std::mutex solverLifetime;
+
+// Interrupts every running solver but 'except'. Not for signal handlers, as it takes the lock.
+void interruptSolvers(const Solver* except = nullptr){
+    std::lock_guard<std::mutex> lock(solverLifetime);
+    for (auto it : series){
+        Solver* other = it->S.load(std::memory_order_acquire);
+        if (other != nullptr && other != except) other->interrupt();
+    }
+}
+
+// Collects from every running solver and retires the ones whose job has finished. 'solved' is
+// read before draining, so the final sample queued at the end of the search is never missed.
+void collectAll(bool wall){
+    for (int i = 0; i < series.size(); i++){
+        Solver* solver = series[i]->S.load(std::memory_order_acquire);
+        if (solver == nullptr) continue;
+        bool done = solver->solved;
+        collectSamples(series[i],solver,wall || done);
+        if (done){
+            if (solver->droppedSamples() > 0)
+                fprintf(stderr,"WARNING! %" PRIu64 " samples of solver %u were dropped; lower refresh_rate or sample less often\n",solver->droppedSamples(),series[i]->id);
+            std::lock_guard<std::mutex> lock(solverLifetime);
+            series[i]->S = nullptr;
+            delete solver;
         }
     }
+}
 
-    ~ThreadPool() {
-        stop.store(true);
-        cv.notify_all();
-        for (auto &t : workers) t.join();
+// One entry of 'cnf_files', or one configuration of the portfolio. Its index is also the index of
+// its series.
+struct Job {
+    string path,logFile,outputFile;
+    string label;       // Legend entry.
+    int config = -1;    // Index into 'portfolioConfigs', or -1 outside portfolio mode.
+};
+vector<Job> jobs;
+
+// Families exported to scrapers, all taken from the solvers' snapshots:
+struct ExportedMetric { const char* name; const char* type; const char* unit; const char* help; uint64_t Solver::Snapshot::* field; };
+const ExportedMetric exportedMetrics[] = {
+    { "minisat_decisions",      "counter", "",      "Branching decisions.",                                    &Solver::Snapshot::decisions    },
+    { "minisat_propagations",   "counter", "",      "Unit propagations.",                                      &Solver::Snapshot::propagations },
+    { "minisat_conflicts",      "counter", "",      "Conflicts.",                                              &Solver::Snapshot::conflicts    },
+    { "minisat_restarts",       "counter", "",      "Restarts.",                                               &Solver::Snapshot::restarts     },
+    { "minisat_gc_events",      "counter", "",      "Garbage collections of the clause database.",             &Solver::Snapshot::gc_events    },
+    { "minisat_learnt_clauses", "gauge",   "",      "Learnt clauses currently in the database.",               &Solver::Snapshot::num_learnts  },
+    { "minisat_memory_bytes",   "gauge",   "bytes", "Estimated memory used by clauses and per-variable data.", &Solver::Snapshot::mem_used     },
+    { "minisat_shared_exported","counter", "",      "Learnt clauses offered to the other portfolio solvers.",  &Solver::Snapshot::shared_exported },
+    { "minisat_shared_imported","counter", "",      "Clauses received from the other portfolio solvers.",      &Solver::Snapshot::shared_imported },
+    { "minisat_shared_useful",  "counter", "",      "Received clauses that took part in a conflict.",          &Solver::Snapshot::shared_useful   },
+};
+
+void appendLabels(string& out,const SolverSeries* S){
+    out += "{solver=\"" + to_string(S->id) + "\",instance=\"";
+    for (char c : jobs[S->id].path){
+        if      (c == '\\') out += "\\\\";
+        else if (c == '"')  out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else                out += c;
+    }
+    out += "\"";
+    if (jobs[S->id].config >= 0) out += ",config=\"" + jobs[S->id].label + "\"";
+    out += "}";
+}
+
+// OpenMetrics text for every solver that has started. Called by 'metricsServer' on the sampling
+// thread, which is the only thread allowed to touch the solvers, so live solvers are read through
+// their snapshot and finished ones report their last sample.
+void writeOpenMetrics(string& out){
+    vector<bool> running(series.size(),false);
+    for (int i = 0; i < series.size(); i++){
+        Solver* solver = series[i]->S.load(std::memory_order_acquire);
+        if (solver == nullptr) continue;
+        solver->readSnapshot(series[i]->latest);
+        running[i] = !solver->solved;
     }
 
-    void pushTask(Task s) {
-        {
-            std::lock_guard<std::mutex> lk(mtx);
-            tasks.push(s);
+    char value[32];
+    for (const ExportedMetric& m : exportedMetrics){
+        out += string("# TYPE ") + m.name + " " + m.type + "\n";
+        if (*m.unit) out += string("# UNIT ") + m.name + " " + m.unit + "\n";
+        out += string("# HELP ") + m.name + " " + m.help + "\n";
+        for (int i = 0; i < series.size(); i++){
+            if (!running[i] && series[i]->lastTime < 0) continue;
+            out += m.name;
+            if (strcmp(m.type,"counter") == 0) out += "_total";
+            appendLabels(out,series[i]);
+            snprintf(value,sizeof(value)," %" PRIu64 "\n",series[i]->latest.*m.field);
+            out += value;
         }
-        cv.notify_one();
     }
+    out += "# TYPE minisat_running gauge\n# HELP minisat_running 1 while the solver is searching.\n";
+    for (int i = 0; i < series.size(); i++){
+        if (!running[i] && series[i]->lastTime < 0) continue;
+        out += "minisat_running";
+        appendLabels(out,series[i]);
+        out += running[i] ? " 1\n" : " 0\n";
+    }
+    out += "# EOF\n";
+}
 
-private:
-    vector<thread> workers;
-    queue<Task> tasks;
-    mutex mtx;
-    condition_variable cv;
-    atomic<bool> stop;
-    void workerLoop() {
-        while (!stop.load()) {
-            Task job = nullptr;
-            int idx;
-            {
-                std::unique_lock<std::mutex> lk(mtx);
-                cv.wait(lk, [&]() {
-                    return stop.load() || !tasks.empty();
-                });
-
-                if (stop.load()) return;
-                job = tasks.front();
-                tasks.pop();
-            }
-            if (job) {
-                job->get_clause_variable_ratio();
-            }
+// Wakes up for wall-clock samples and for refreshes only, draining the event samples each time,
+// until 'stopFlag' is set. In between it answers scrapes if 'metricsServer' is listening. Once
+// stopped, it interrupts the solvers still running and collects what they have queued; the final
+// refresh is left to the caller.
+void sampleLoop(const std::function<void()>& refresh){
+    double nextWall = 0, nextRefresh = realTime() + refreshRate;
+    while (!stopFlag){
+        double now = realTime();
+        bool wall = sampleWall > 0 && now >= nextWall;
+        if (wall) nextWall = now + sampleWall;
+        collectAll(wall);
+        if (now >= nextRefresh){
+            refresh();
+            nextRefresh = realTime() + refreshRate;
         }
+        double wake = sampleWall > 0 ? std::min(nextWall,nextRefresh) : nextRefresh;
+        double left = wake - realTime();
+        if      (left <= 0) continue;
+        else if (metricsServer.isOpen()) metricsServer.serve(left,writeOpenMetrics);
+        else    std::this_thread::sleep_for(std::chrono::duration<double>(left));
     }
+    interruptSolvers();
+    collectAll(true);
+}
+
+//data accessors for different stats
+inline const BoundedSeries& getDecisionVector(const SolverSeries* S)    {return S->decisionVector;}
+inline const BoundedSeries& getUnitPropVector(const SolverSeries* S)    {return S->unitPropsVector;}
+inline const BoundedSeries& getConflictVector(const SolverSeries* S)    {return S->conflictVector;}
+inline const BoundedSeries& getClauseDBVector(const SolverSeries* S)    {return S->clauseDBVector;}
+inline const BoundedSeries& getGCEventsVector(const SolverSeries* S)    {return S->gcEventsVector;}
+inline const BoundedSeries& getLearntClauseVector(const SolverSeries* S){return S->learntClausesVector;}
+inline const BoundedSeries& getRestartEventVector(const SolverSeries* S){return S->restartEventsVector;}
+inline const BoundedSeries& getClauseVariableRatioVector(const SolverSeries* S){return S->clauseVarRatioVector;}
+inline const BoundedSeries& getAvgLbdVector(const SolverSeries* S)      {return S->avgLbdVector;}
+inline const BoundedSeries& getBackjumpVector(const SolverSeries* S)    {return S->backjumpVector;}
+inline const BoundedSeries& getConflictLevelVector(const SolverSeries* S){return S->conflictLevelVector;}
+inline const BoundedSeries& getTopKActivityVector(const SolverSeries* S){return S->topKActivityVector;}
+
+const vector<dataAccessorFunction> dataAccessor = {getDecisionVector,getUnitPropVector,getConflictVector,getClauseDBVector,getGCEventsVector,getLearntClauseVector,getRestartEventVector,getClauseVariableRatioVector,getAvgLbdVector,getBackjumpVector,getConflictLevelVector,getTopKActivityVector};
+
+
+// Live view: one subplot per enabled metric holding a persistent line per solver. A refresh only
+// hands the lines of solvers that got new samples their (bounded) data, and only moves an axis'
+// limits when the data outgrew them, so nothing is cleared or re-created while the run lasts.
+struct MetricPanel {
+    int metric_no;
+    vector<plt::Plot*> lines;       // One per solver.
+    vector<double> drawnTime;       // 'lastTime' of each solver as of its last update.
+    bool empty;
+    double xmax,ymin,ymax;          // Current view limits (x always starts at 0).
 };
+vector<MetricPanel> panels;
 
-ThreadPool pool(5);
+const double panelHeadroom = 0.25;  // Fraction by which an outgrown axis is extended.
 
-//easy statistics minisat already tracks them
-inline void updateTimestamp(Solver* S){(!S->timestamps.size()) ? S->timestamps.push(1) : S->timestamps.push((S->timestamps).last()+1);}
-inline void updateDecisions(Solver* S){if (metric.flags[0]) S->decisionVector.push(S->decisions);}
-inline void updateUnitProps(Solver* S){if (metric.flags[1]) S->unitPropsVector.push(S->propagations);}
-inline void updateConflictsCount(Solver* S){if (metric.flags[2]) S->conflictVector.push(S->conflicts);}
-inline void updateClauseDBSize(Solver* S){if (metric.flags[3]) S->clauseDBVector.push(((double)S->num_clauses) + ((double)S->num_learnts));}
-inline void updateGCEvents(Solver* S){if (metric.flags[4]) S->gcEventsVector.push(S->gcEvents);}
-inline void updateLearntClauses(Solver* S){if (metric.flags[5]) S->learntClausesVector.push(S->num_learnts);}
-inline void updateRestartEvents(Solver* S){if (metric.flags[6]) S->restartEventsVector.push(S->curr_restarts);}
-inline void updateClauseVariableRatio(Solver* S){if (metric.flags[7]) {pool.pushTask(S);}}
-
-//data accessors for different stats
-inline const vec<double>& getDecisionVector(const Solver* S)    {return S->decisionVector;}
-inline const vec<double>& getUnitPropVector(const Solver* S)    {return S->unitPropsVector;}
-inline const vec<double>& getConflictVector(const Solver* S)    {return S->conflictVector;}
-inline const vec<double>& getClauseDBVector(const Solver* S)    {return S->clauseDBVector;}
-inline const vec<double>& getGCEventsVector(const Solver* S)    {return S->gcEventsVector;}
-inline const vec<double>& getLearntClauseVector(const Solver* S){return S->learntClausesVector;}
-inline const vec<double>& getRestartEventVector(const Solver* S){return S->restartEventsVector;}
-inline const vec<double>& getClauseVariableRatioVector(const Solver* S){return S->clauseVariableRatioVector;}
+void buildPanels(){
+    int cols = ceil(sqrt(active_metrics));
+    int rows = ceil((double)active_metrics/cols);
+    int idx = 1;
+    for (int metric_no = 0; metric_no < num_plotted_metrics; metric_no++){
+        if (!metric.flags[metric_no]) continue;
+        plt::subplot(rows, cols, idx++);
+        plt::title(options[metric_no]);
+        MetricPanel p;
+        p.metric_no = metric_no;
+        p.empty = true;
+        p.xmax = p.ymin = p.ymax = 0;
+        for (int i = 0; i < series.size(); i++){
+            p.lines.push_back(new plt::Plot(jobs[i].label));
+            p.drawnTime.push_back(-1);
+        }
+        plt::legend({{"loc", "upper left"}});
+        panels.push_back(p);
+    }
+    plt::tight_layout();
+    plt::subplots_adjust({{"top", 0.93}});
+}
 
-const vector<dataAccessorFunction> dataAccessor = {getDecisionVector,getUnitPropVector,getConflictVector,getClauseDBVector,getGCEventsVector,getLearntClauseVector,getRestartEventVector,getClauseVariableRatioVector};
+void updatePanel(MetricPanel& p){
+    double xmax = p.xmax, ymin = p.ymin, ymax = p.ymax;
+    bool   empty = p.empty;
+    for (int i = 0; i < series.size(); i++){
+        if (series[i]->lastTime == p.drawnTime[i]) continue;
+        const BoundedSeries& data = dataAccessor[p.metric_no](series[i]);
+        p.drawnTime[i] = series[i]->lastTime;
+        if (data.size() == 0) continue;
+        p.lines[i]->update(data.times(),data.values());
+        if (empty || data.times().last() > xmax) xmax = data.times().last();
+        if (empty || data.minValue()     < ymin) ymin = data.minValue();
+        if (empty || data.maxValue()     > ymax) ymax = data.maxValue();
+        empty = false;
+    }
+    if (empty || (!p.empty && xmax <= p.xmax && ymin >= p.ymin && ymax <= p.ymax)) return;
+
+    // Outgrown: extend by some headroom, so that steadily growing data only rarely rescales.
+    double span = std::max(ymax - ymin,std::max(fabs(ymax),1.0) * 1e-3);
+    p.xmax  = xmax > p.xmax || p.empty ? std::max(xmax * (1 + panelHeadroom),1e-3) : p.xmax;
+    p.ymin  = ymin < p.ymin || p.empty ? ymin - span * panelHeadroom : p.ymin;
+    p.ymax  = ymax > p.ymax || p.empty ? ymax + span * panelHeadroom : p.ymax;
+    p.empty = false;
+    p.lines[0]->set_limits(0,p.xmax,p.ymin,p.ymax);
+}
 
+void drawMetrics(const char* title){
+    if (panels.empty()) buildPanels();
+    for (MetricPanel& p : panels) updatePanel(p);
+    plt::suptitle(title);
+}
 
 void plotMetrics(string path){
-    int cols = ceil(sqrt(active_metrics));
-    int rows = ceil((double)active_metrics/cols);
     plt::figure_size(1300,900);
-    bool flag = false;
-    while (!stopFlag){
+    sampleLoop([](){
         try{
-            int idx = 1;
-            if (flag) plt::clf();
-
-            for (int i = 0; i < solvers.size();i++){
-                if (!solvers[i]->solved){
-                    updateTimestamp(solvers[i]);
-                    updateDecisions(solvers[i]);
-                    updateUnitProps(solvers[i]);
-                    updateConflictsCount(solvers[i]);
-                    updateClauseDBSize(solvers[i]);
-                    updateGCEvents(solvers[i]);
-                    updateLearntClauses(solvers[i]);
-                    updateRestartEvents(solvers[i]);
-                    updateClauseVariableRatio(solvers[i]);
-                }
-            }
-            for (int metric_no = 0; metric_no < 8; metric_no++){
-                if (metric.flags[metric_no]){
-                    plt::subplot(rows, cols, idx++);
-                    plt::title(options[metric_no]);
-                    for (int i = 0; i < solvers.size(); i++) {
-                        if (solvers[i]->timestamps.size() == dataAccessor[metric_no](solvers[i]).size()) plt::plot(solvers[i]->timestamps,dataAccessor[metric_no](solvers[i]));
-                        else plt::plot(solvers[i]->threadedTimestamp,dataAccessor[metric_no](solvers[i]));
-                    }
-                    plt::legend({{"loc", "upper left"}});
-                }
-            }
-            plt::tight_layout();
-            plt::subplots_adjust({{"top", 0.93}});
-            plt::suptitle("SAT Metrics Visualizer");
+            drawMetrics("SAT Metrics Visualizer");
             plt::pause(0.01);
-            flag = true;
-            std::this_thread::sleep_for(std::chrono::seconds(2));
         }
         catch(const exception& e){
-            std::this_thread::sleep_for(std::chrono::seconds(2));
             cout << e.what() << endl;
         }
-    }
-    plt::clf();
-    int idx2 = 1;
-    for (int metric_no = 0; metric_no < 7; metric_no++){
-        if (metric.flags[metric_no]){
-            plt::subplot(rows, cols, idx2++);
-            plt::title(options[metric_no]);
-            for (int i = 0; i < solvers.size(); i++) plt::plot(solvers[i]->timestamps,dataAccessor[metric_no](solvers[i]));
-            plt::legend({{"loc", "upper left"}});
-        }
-    }
-    plt::tight_layout();
-    plt::subplots_adjust({{"top", 0.93}});
-    plt::suptitle("Metric Comparison Graph");
+    });
+    drawMetrics("Metric Comparison Graph");
     plt::save(path);
+    for (MetricPanel& p : panels)
+        for (plt::Plot* line : p.lines) delete line;
+    panels.clear();
     plt::close();
     sem_post(&pauseSem);
 }
 
+void recordMetrics(){
+    sampleLoop([](){ if (metricStream.isOpen()) metricStream.flush(); });
+    metricStream.close();
+    sem_post(&pauseSem);
+}
+
+
+
+std::atomic<int> nextJob(0);
+int cpuLimit = 0, memLimit = 0;     // Per instance, in seconds of the solving thread's CPU-time / megabytes.
+
+//=================================================================================================
+// Portfolio mode ("portfolio" in 'config.json'): a single instance, parsed once, is raced by
+// differently configured solvers. The first definite answer wins and interrupts all the others.
+
+struct SolverConfig {
+    double random_seed, random_var_freq, var_decay;
+    bool   luby_restart;
+    int    restart_first, phase_saving, ccmin_mode;
+};
+
+// The i:th default configuration. Configuration 0 is plain MiniSat; the others vary the decision
+// heuristic, the restart strategy, phase saving and minimization, and branch randomly 1% of the time
+// so that their seeds matter.
+SolverConfig diversifiedConfig(int i){
+    static const double decay[] = { 0.95, 0.85, 0.92, 0.99, 0.90, 0.80 };
+    static const int    first[] = { 100,  50,   200,  400,  100,  30   };
+    static const int    phase[] = { 2,    1,    2,    0,    2,    1    };
+    static const int    ccmin[] = { 2,    2,    1,    2,    0,    2    };
+    int k = i % 6;
+    SolverConfig c;
+    c.random_seed     = 91648253 + 7919 * i;
+    c.random_var_freq = i == 0 ? 0 : 0.01;
+    c.var_decay       = decay[k];
+    c.luby_restart    = (i % 2) == 0;
+    c.restart_first   = first[k];
+    c.phase_saving    = phase[k];
+    c.ccmin_mode      = ccmin[k];
+    return c;
+}
+
+void parseConfig(json& cfg,SolverConfig& c){
+    if (cfg.contains("random_seed"))     c.random_seed     = cfg["random_seed"].get<double>();
+    if (cfg.contains("random_var_freq")) c.random_var_freq = cfg["random_var_freq"].get<double>();
+    if (cfg.contains("var_decay"))       c.var_decay       = cfg["var_decay"].get<double>();
+    if (cfg.contains("luby_restart"))    c.luby_restart    = cfg["luby_restart"].get<bool>();
+    if (cfg.contains("restart_first"))   c.restart_first   = cfg["restart_first"].get<int>();
+    if (cfg.contains("phase_saving"))    c.phase_saving    = cfg["phase_saving"].get<int>();
+    if (cfg.contains("ccmin_mode"))      c.ccmin_mode      = cfg["ccmin_mode"].get<int>();
+}
+
+string configLabel(int i,const SolverConfig& c){
+    char buf[128];
+    snprintf(buf,sizeof(buf),"#%d decay=%g %s/%d phase=%d ccmin=%d",i,c.var_decay,c.luby_restart ? "luby" : "geom",c.restart_first,c.phase_saving,c.ccmin_mode);
+    return buf;
+}
+
+void applyConfig(Solver* S,const SolverConfig& c){
+    S->random_seed     = c.random_seed;
+    S->random_var_freq = c.random_var_freq;
+    S->var_decay       = c.var_decay;
+    S->luby_restart    = c.luby_restart;
+    S->restart_first   = c.restart_first;
+    S->phase_saving    = c.phase_saving;
+    S->ccmin_mode      = c.ccmin_mode;
+}
+
+// The portfolio instance, kept in a flat clause list so every solver can be loaded from memory.
+// Implements just enough of the solver interface for 'parse_DIMACS()'.
+class ParsedCNF {
+    int      vars = 0;
+    vec<Lit> lits;
+    vec<int> offsets;       // Clause 'i' is 'lits[offsets[i]] .. lits[offsets[i+1]-1]'.
+    vec<Lit> firstClause;
+public:
+    ParsedCNF() { offsets.push(0); }
+    int  nVars    () const { return vars; }
+    Var  newVar   ()       { return vars++; }
+    void reserveVars(int)  {}
+    void bindFirstClauseVariables(vec<Lit>& c) { c.copyTo(firstClause); }
+    bool addClauses(vec<Lit>& ls, const vec<int>& offs){
+        int base = lits.size();
+        for (int i = 0; i < ls.size(); i++) lits.push(ls[i]);
+        for (int i = 1; i < offs.size(); i++) offsets.push(base + offs[i]);
+        return true; }
+
+    // 'addClauses()' normalizes in place, so every solver gets its own copy:
+    void loadInto(Solver& S) const {
+        vec<Lit> c;
+        S.reserveVars(vars);
+        while (S.nVars() < vars) S.newVar();
+        firstClause.copyTo(c);
+        if (c.size() > 0) S.bindFirstClauseVariables(c);
+        lits.copyTo(c);
+        S.addClauses(c, offsets);
+    }
+};
+
+vector<SolverConfig> portfolioConfigs;
+ParsedCNF portfolioCNF;
+ClauseExchange* portfolioExchange = nullptr;   // Set if the configurations share learnt clauses.
+std::atomic<int> portfolioWinner(-1);
+double portfolioStart = 0;
+
+// Reports the outcome of a portfolio configuration. The first one with a definite answer stops
+// handing out configurations and interrupts every solver still running.
+void finishPortfolioJob(int j,Solver* S,lbool ret){
+    const Job& job = jobs[j];
+    const char* result = ret == l_True ? "SATISFIABLE" : ret == l_False ? "UNSATISFIABLE" : "INDETERMINATE";
+    int none = -1;
+    if (ret == l_Undef || !portfolioWinner.compare_exchange_strong(none,j)){
+        printf("%s: %s (%s)\n",job.path.c_str(),result,job.label.c_str());
+        return;
+    }
+
+    printf("%s: %s (won by %s after %.2f s)\n",job.path.c_str(),result,job.label.c_str(),realTime() - portfolioStart);
+    nextJob = jobs.size();
+    interruptSolvers(S);
+}
+
+void runJob(int j){
+    const Job& job = jobs[j];
+    string logFile = job.logFile, outputFile = job.outputFile;
+    Solver* S = new Solver(logFile,outputFile);
+    S->verbosity = true;
+    S->trackClauseVarRatio = metric.flags[7];
+    configureSampling(S);
+    if (job.config >= 0) applyConfig(S,portfolioConfigs[job.config]);
+    if (job.config >= 0 && portfolioExchange != nullptr) S->setClauseExchange(portfolioExchange,job.config);
+    try{
+        if (job.config >= 0){
+            portfolioCNF.loadInto(*S);
+            if (portfolioWinner >= 0) S->solved = true;     // Already decided; don't even start.
+        }
+        else if (!parse_DIMACS(job.path.c_str(), *S, false)){
+            printf("ERROR! Could not open file: %s\n",job.path.c_str());
+            S->solved = true;
+        }
+        series[j]->S.store(S,std::memory_order_release);
+        if (S->solved) return;
+
+        if (cpuLimit != 0) S->setCpuBudget(cpuLimit);
+        if (memLimit != 0) S->setMemBudget((uint64_t)memLimit * 1024 * 1024);
+        lbool ret = l_False;
+        if (S->simplify()){
+            vec<Lit> dummy;
+            ret = S->solveLimited(dummy);
+        }
+        if (job.config >= 0) finishPortfolioJob(j,S,ret);
+        else printf("%s: %s\n",job.path.c_str(),ret == l_True ? "SATISFIABLE" : ret == l_False ? "UNSATISFIABLE" : "INDETERMINATE");
+    }
+    catch (OutOfMemoryException&){
+        printf("%s: INDETERMINATE (out of memory)\n",job.path.c_str());
+        series[j]->S.store(S,std::memory_order_release);
+    }
+    S->solved = true;   // From here on the plotting thread owns (and eventually deletes) 'S'.
+}
 
 
 int main(int argc, char** argv){
@@ -254,8 +605,8 @@ int main(int argc, char** argv){
 
         file >> config;
 
-        int cpu_lim = (config.contains("cpu_lim")) ? config["cpu_lim"].get<int>():0;
-        int mem_lim = (config.contains("mem_lim")) ? config["mem_lim"].get<int>():0;
+        cpuLimit = (config.contains("cpu_lim")) ? config["cpu_lim"].get<int>():0;
+        memLimit = (config.contains("mem_lim")) ? config["mem_lim"].get<int>():0;
         bool verbosity = (config.contains("verbosity") ? config["verbosity"].get<bool>():true);
 
         string logDirectory,outDirectory,graphDirectory,graphFile;
@@ -264,6 +615,8 @@ int main(int argc, char** argv){
         outDirectory = (config.contains("output") && config["output"].contains("result_directory")) ? config["output"]["result_directory"] : "output" ;
         graphDirectory = (config.contains("output") && config["output"].contains("graph_directory")) ? config["output"]["graph_directory"] : "output" ;
         graphFile  = (config.contains("output") && config["output"].contains("graph_file")) ? config["output"]["graph_file"] : "final_graph";
+        headless = (config.contains("headless") ? config["headless"].get<bool>():false);
+        string streamFile = (config.contains("output") && config["output"].contains("metric_stream")) ? config["output"]["metric_stream"].get<string>() : graphDirectory + "/" + graphFile + ".mstream";
 
         bool f1 = createIfNotExists(logDirectory);
         bool f2 = createIfNotExists(outDirectory);
@@ -277,63 +630,123 @@ int main(int argc, char** argv){
         assert(config.contains("metrics"));
         for (int i = 0; i < options.size();i++) parseMetrics(config["metrics"],metric.flags[i],options[i]);
 
-        auto solverFunction = [&](Solver* S)->void{
-            if (cpu_lim != 0) limitTime(cpu_lim);
-            if (mem_lim != 0) limitMemory(mem_lim);
-            if (!S->simplify()){
-                printf("UNSATISFIABLE\n");
-                exit(20);
+        // "openmetrics": {"port": N} or {"unix_socket": path}. A scrape endpoint replaces the default
+        // metric stream in headless mode unless "metric_stream" is given explicitly.
+        bool serveMetrics = config.contains("openmetrics");
+        if (serveMetrics){
+            json& om = config["openmetrics"];
+            bool ok = om.contains("unix_socket") ? metricsServer.listenUnix(om["unix_socket"].get<string>().c_str())
+                                                 : metricsServer.listenTcp(om.contains("port") ? om["port"].get<int>() : 9464);
+            if (!ok){
+                cerr << "Exiting visualizer! Fatal Error, Unable to listen for metric scrapes: " << strerror(errno) << endl;
+                _exit(404);
             }
-            vec<Lit> dummy;
-            lbool ret = S -> solveLimited(dummy);
-            printf(ret == l_True ? "SATISFIABLE\n" : ret == l_False ? "UNSATISFIABLE\n" : "INDETERMINATE\n");
-            S -> solved = true;
-        };
-
-        if (!file.is_open()){
-            cerr << " Error opening File " << endl;
+        }
+        bool writeStream = headless && (!serveMetrics || (config.contains("output") && config["output"].contains("metric_stream")));
+        if (writeStream && !metricStream.open(streamFile.c_str())){
+            cerr << "Exiting visualizer! Fatal Error, Unable to create metric stream " << streamFile << endl;
             _exit(404);
         }
 
-
-        for (auto &cnf : config["cnf_files"]){
-            string path = cnf["path"];
-            string default_log_file = path + "_stats.log";
-            string logFile = ((cnf.contains("log_file"))?cnf["log_file"].get<string>():default_log_file);
-            std::replace(default_log_file.begin(),default_log_file.end(),'\\','_');
-            logFile = logDirectory + "/" + logFile;
-            string default_output_file = path + "_result.cnf";
-            std::replace(default_output_file.begin(),default_output_file.end(),'\\','_');
-            string outputFile = ((cnf.contains("result_file"))?cnf["result_file"].get<string>():default_output_file);
-            outputFile = outDirectory + "/" + outputFile;
-            Solver* S = new Solver(logFile,outputFile);
-            S->verbosity = true;
-            gzFile in = gzopen(path.c_str(),"rb");
-            if (in == NULL){
-                printf("ERROR! Could not open file: %s\n",path);
+        unsigned cores = std::max(1u,thread::hardware_concurrency());
+        int workers = (config.contains("workers")) ? config["workers"].get<int>() : (int)std::max(1u,cores - 1);
+        bool pinCores = (config.contains("pin_cores") ? config["pin_cores"].get<bool>():false);
+        refreshRate = (config.contains("refresh_rate")) ? config["refresh_rate"].get<double>() : 2;
+        if (refreshRate <= 0) refreshRate = 2;
+        sampleWall = refreshRate;
+        if (config.contains("sampling")){
+            json& sampling = config["sampling"];
+            if (sampling.contains("wall"))      sampleWall      = sampling["wall"].get<double>();
+            if (sampling.contains("conflicts")) sampleConflicts = sampling["conflicts"].get<int>();
+            if (sampling.contains("restarts"))  sampleRestarts  = sampling["restarts"].get<bool>();
+            if (sampling.contains("reduce_db")) sampleReduceDB  = sampling["reduce_db"].get<bool>();
+        }
+        uint64_t seriesBytes = (config.contains("series_bytes")) ? config["series_bytes"].get<uint64_t>() : 64 * 1024;
+
+        if (config.contains("portfolio")){
+            // "portfolio": {"path": cnf, "solvers": N, "configs": [overrides of the i:th default, ...]}
+            json& pf = config["portfolio"];
+            string path = pf["path"].get<string>();
+            int n = pf.contains("solvers") ? pf["solvers"].get<int>() : (int)std::max(1u,cores);
+            if (pf.contains("configs")) n = std::max<int>(n,pf["configs"].size());
+            if (!parse_DIMACS(path.c_str(),portfolioCNF,false)){
+                cerr << "Exiting visualizer! Fatal Error, Unable to open " << path << endl;
                 _exit(404);
             }
-            parse_DIMACS(in, *S, false);
-            gzclose(in);
-            solvers.push_back(S);
-            threads.emplace_back(solverFunction,S); 
+
+            string base = path;
+            std::replace_if(base.begin(),base.end(),[](char c){return c == '/' || c == '\\';},'_');
+            for (int i = 0; i < n; i++){
+                SolverConfig c = diversifiedConfig(i);
+                if (pf.contains("configs") && i < (int)pf["configs"].size()) parseConfig(pf["configs"][i],c);
+                portfolioConfigs.push_back(c);
+                Job job;
+                job.path = path;
+                job.config = i;
+                job.label = configLabel(i,c);
+                job.logFile = logDirectory + "/" + base + "_cfg" + to_string(i) + "_stats.log";
+                job.outputFile = outDirectory + "/" + base + "_cfg" + to_string(i) + "_result.cnf";
+                jobs.push_back(job);
+                series.push_back(new SolverSeries(series.size(),BoundedSeries::capacityFor(seriesBytes)));
+            }
+            if (!config.contains("workers")) workers = n;   // A race needs every configuration running.
+
+            // "share": true, or {"max_size": N, "max_lbd": N, "slots": N} to tune the exchange filter.
+            if (pf.contains("share") && !(pf["share"].is_boolean() && !pf["share"].get<bool>())){
+                json& sh = pf["share"];
+                portfolioExchange = new ClauseExchange(n,sh.is_object() && sh.contains("slots") ? sh["slots"].get<uint32_t>() : 4096);
+                if (sh.is_object() && sh.contains("max_size")) portfolioExchange->max_size = sh["max_size"].get<int>();
+                if (sh.is_object() && sh.contains("max_lbd"))  portfolioExchange->max_lbd  = sh["max_lbd"].get<int>();
+            }
+            portfolioStart = realTime();
         }
+        else for (auto &cnf : config["cnf_files"]){
+            Job job;
+            job.path = cnf["path"];
+            string default_log_file = job.path + "_stats.log";
+            std::replace_if(default_log_file.begin(),default_log_file.end(),[](char c){return c == '/' || c == '\\';},'_');
+            job.logFile = logDirectory + "/" + ((cnf.contains("log_file"))?cnf["log_file"].get<string>():default_log_file);
+            string default_output_file = job.path + "_result.cnf";
+            std::replace_if(default_output_file.begin(),default_output_file.end(),[](char c){return c == '/' || c == '\\';},'_');
+            job.outputFile = outDirectory + "/" + ((cnf.contains("result_file"))?cnf["result_file"].get<string>():default_output_file);
+            job.label = "solver " + to_string(jobs.size());
+            jobs.push_back(job);
+            series.push_back(new SolverSeries(series.size(),BoundedSeries::capacityFor(seriesBytes)));
+        }
+        if (workers < 1) workers = 1;
+        if (workers > (int)jobs.size()) workers = std::max<int>(1,jobs.size());
+
+        // Jobs are handed out in config order; each worker parses and then solves one instance at a
+        // time, so at most 'workers' instances are in memory and parsing overlaps with solving.
+        auto workerFunction = [&](int worker)->void{
+            if (pinCores && !pinThread(worker % cores))
+                fprintf(stderr,"WARNING! Could not pin worker %d to core %u\n",worker,worker % cores);
+            for (int j; (j = nextJob++) < (int)jobs.size();) runJob(j);
+        };
+
+        if (metricStream.isOpen())
+            for (size_t i = 0; i < jobs.size(); i++) metricStream.appendLabel(i,jobs[i].label.c_str());
 
         cout << active_metrics << endl;
         string full_path = graphDirectory + graphFile;
-        thread t1(plotMetrics,full_path);
+        thread t1 = headless ? thread(recordMetrics) : thread(plotMetrics,full_path);
 
-        signal(SIGINT,[](int sig){
+        // The sampling thread interrupts the solvers once it sees 'stopFlag'; the handler must not
+        // touch them, as they may be deleted under its feet:
+        signal(SIGINT,[](int){
             stopFlag = true;
-            for (auto it : solvers) it -> interrupt();
+            nextJob = jobs.size();
             sem_wait(&pauseSem);
             _exit(1);
         });
 
+        for (int i = 0; i < workers; i++) threads.emplace_back(workerFunction,i);
         for (int i = 0; i < threads.size();i++) threads[i].join();
         stopFlag = true;
-        sem_wait(&pauseSem);
-        for (auto S : solvers) delete S;
+        t1.join();
+        metricsServer.close();
+        for (auto S : series) delete S;
+        delete portfolioExchange;
         printf(" All Simulations Over \n");
     } 
     catch (OutOfMemoryException&){
@@ -425,6 +425,16 @@ PyObject* get_array(const std::vector<Numeric>& v)
     return list;
 }
 
+template<typename Numeric>
+PyObject* get_array(const Minisat::vec<Numeric>& v)
+{
+    PyObject* list = PyList_New(v.size());
+    for(int i = 0; i < v.size(); ++i) {
+        PyList_SetItem(list, i, PyFloat_FromDouble(v[i]));
+    }
+    return list;
+}
+
 #endif // WITHOUT_NUMPY
 
 // sometimes, for labels and such, we need string arrays
@@ -2957,9 +2967,10 @@ public:
             line= PyList_GetItem(res, 0);
 
             if(line)
+            {
+                Py_INCREF(line);    // (borrowed from 'res', but released in 'decref()')
                 set_data_fct = PyObject_GetAttrString(line,"set_data");
-            else
-                Py_DECREF(line);
+            }
             Py_DECREF(res);
         }
     }
@@ -2988,6 +2999,38 @@ public:
         return false;
     }
 
+    //arpan: minisat-style vectors, as for 'plot()'
+    template<typename Numeric>
+    bool update(const Minisat::vec<Numeric>& x, const Minisat::vec<Numeric>& y) {
+        assert(x.size() == y.size());
+        if(set_data_fct)
+        {
+            PyObject* plot_args = PyTuple_New(2);
+            PyTuple_SetItem(plot_args, 0, detail::get_array(x));
+            PyTuple_SetItem(plot_args, 1, detail::get_array(y));
+
+            PyObject* res = PyObject_CallObject(set_data_fct, plot_args);
+            Py_DECREF(plot_args);
+            if (res) Py_DECREF(res);
+            return res;
+        }
+        return false;
+    }
+
+    // sets the view limits of the axes this line belongs to (lines don't autoscale on update)
+    bool set_limits(double xmin, double xmax, double ymin, double ymax) {
+        if(!line) return false;
+        PyObject* axes = PyObject_GetAttrString(line, "axes");
+        if(!axes) return false;
+        PyObject* rx = PyObject_CallMethod(axes, "set_xlim", "(dd)", xmin, xmax);
+        PyObject* ry = PyObject_CallMethod(axes, "set_ylim", "(dd)", ymin, ymax);
+        bool ok = rx && ry;
+        Py_XDECREF(rx);
+        Py_XDECREF(ry);
+        Py_DECREF(axes);
+        return ok;
+    }
+
     // clears the plot but keep it available
     bool clear() {
         return update(std::vector<double>(), std::vector<double>());
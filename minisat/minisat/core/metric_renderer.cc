@@ -0,0 +1,131 @@
+/********************************************************************************[metric_renderer.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Renders a metric stream written by the visualizer in headless mode. Produces the same comparison
+// graph as the in-process plotter, either once from a finished stream or live while it grows.
+
+#include "minisat/utils/System.h"
+#include "minisat/utils/Options.h"
+#include "minisat/utils/MetricStream.h"
+#include "minisat/core/VizMetrics.h"
+#include <thread>
+#include <chrono>
+#include "matplotlibcpp.h"
+
+using namespace Minisat;
+using namespace std;
+namespace plt = matplotlibcpp;
+
+//=================================================================================================
+
+struct RenderSeries { vector<double> time, value; };
+
+// series[metric][solver]:
+static vector<vector<RenderSeries> > series(num_viz_metrics);
+static vector<string>                labels;    // Names from label records, by solver.
+
+
+// Reads records [from, to) into 'series':
+static void collect(const MetricStreamReader& in, uint64_t from, uint64_t to)
+{
+    for (uint64_t i = from; i < to; i++){
+        const MetricRecord& r = in[i];
+        if (r.metric == (uint32_t)metric_label){
+            char piece[17];
+            r.labelText(piece);
+            if (labels.size() <= r.solver) labels.resize(r.solver + 1);
+            labels[r.solver] += piece;
+            continue; }
+        if (r.metric >= (uint32_t)num_viz_metrics) continue;    // Written by a newer producer.
+        vector<RenderSeries>& m = series[r.metric];
+        if (m.size() <= r.solver) m.resize(r.solver + 1);
+        m[r.solver].time .push_back(r.time);
+        m[r.solver].value.push_back(r.value);
+    }
+}
+
+
+static void render(const char* title)
+{
+    int active = 0;
+    for (int m = 0; m < num_viz_metrics; m++) if (series[m].size() > 0) active++;
+    if (active == 0) return;
+
+    int cols = ceil(sqrt(active));
+    int rows = ceil((double)active/cols);
+    int idx  = 1;
+    for (int m = 0; m < num_viz_metrics; m++){
+        if (series[m].size() == 0) continue;
+        plt::subplot(rows, cols, idx++);
+        plt::title(viz_metric_names[m]);
+        for (int s = 0; s < (int)series[m].size(); s++)
+            plt::named_plot(s < (int)labels.size() && labels[s] != "" ? labels[s] : "solver " + to_string(s),
+                            series[m][s].time, series[m][s].value);
+        plt::legend({{"loc", "upper left"}});
+    }
+    plt::tight_layout();
+    plt::subplots_adjust({{"top", 0.93}});
+    plt::suptitle(title);
+}
+
+
+int main(int argc, char** argv)
+{
+    setUsageHelp("USAGE: %s [options] <metric-stream> [graph-file]\n\n  where graph-file defaults to <metric-stream>.png.\n");
+    BoolOption   live   ("MAIN", "live",    "Redraw while the stream is still being written.", false);
+    DoubleOption refresh("MAIN", "refresh", "Seconds between redraws in live mode.", 2, DoubleRange(0, false, HUGE_VAL, false));
+    parseOptions(argc, argv, true);
+
+    if (argc < 2){
+        fprintf(stderr, "ERROR! No metric stream given. Use '--help' for help.\n");
+        exit(1); }
+
+    string graph = argc >= 3 ? argv[2] : string(argv[1]) + ".png";
+
+    MetricStreamReader in;
+    if (!in.open(argv[1])){
+        fprintf(stderr, "ERROR! Could not open metric stream: %s\n", argv[1]);
+        exit(1); }
+
+    uint64_t seen = 0;
+    plt::figure_size(1300,900);
+
+    if (live){
+        for (;;){
+            bool done = in.closed();            // Checked first, so the last records are not missed.
+            uint64_t n = in.refresh();
+            collect(in, seen, n);
+            seen = n;
+            plt::clf();
+            render("SAT Metrics Visualizer");
+            plt::pause(0.01);
+            if (done) break;
+            std::this_thread::sleep_for(std::chrono::duration<double>((double)refresh));
+        }
+        plt::clf();
+    }else{
+        uint64_t n = in.refresh();
+        collect(in, seen, n);
+        seen = n;
+    }
+
+    render("Metric Comparison Graph");
+    plt::save(graph);
+    plt::close();
+    printf("Rendered %" PRIu64 " records to %s\n", seen, graph.c_str());
+    return 0;
+}
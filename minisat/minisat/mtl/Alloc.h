@@ -54,10 +54,16 @@ class RegionAllocator
 
     uint32_t size      () const      { return sz; }
     uint32_t wasted    () const      { return wasted_; }
+    void     reserve   (uint32_t min_cap) { capacity(min_cap); }
 
     Ref      alloc     (int size); 
     void     free      (int size)    { wasted_ += size; }
 
+    // The whole region as one block, e.g. to save it, or to restore it by filling in the block
+    // returned by 'restore()':
+    const T* data      () const      { return memory; }
+    T*       restore   (uint32_t size, uint32_t wasted) { capacity(size); sz = size; wasted_ = wasted; return memory; }
+
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
     T&       operator[](Ref r)       { assert(r < sz); return memory[r]; }
     const T& operator[](Ref r) const { assert(r < sz); return memory[r]; }
@@ -0,0 +1,127 @@
+/*********************************************************************************[BoundedSeries.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_BoundedSeries_h
+#define Minisat_BoundedSeries_h
+
+#include <assert.h>
+
+#include "minisat/mtl/Vec.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Fixed-capacity (x, y) series with online min/max downsampling:
+//
+// Points are appended in x order. The newest points (up to half the capacity) are kept at full
+// resolution. Older points move to a history where every bucket of '2*stride' consecutive points
+// is reduced to the two with the minimum and maximum y, so peaks survive. When the history fills
+// up, it is halved the same way and 'stride' doubles, so the whole run stays uniformly covered.
+// Memory never exceeds 'capacity()' points, and redrawing is O(capacity).
+
+class BoundedSeries {
+    vec<double> xs, ys;         // History in [0, hist), recent points in [hist, size()).
+    int         cap;
+    int         hist;
+    int         stride;
+    double      min_y, max_y;   // Extremes over everything pushed (downsampling always keeps them).
+
+    // Partially filled history bucket:
+    int         pending;
+    double      lo_x, lo_y, hi_x, hi_y;
+
+    // Appends the min/max pair of a bucket at position 'w' (in x order, once if they coincide):
+    void emit(int& w, double ax, double ay, double bx, double by) {
+        xs[w] = ax; ys[w] = ay; w++;
+        if (ax != bx){
+            xs[w] = bx; ys[w] = by; w++; } }
+
+    // Moves 'n' points starting at 'from' down to 'to':
+    void slide(int from, int to, int n) {
+        for (int i = 0; i < n; i++){
+            xs[to + i] = xs[from + i];
+            ys[to + i] = ys[from + i]; } }
+
+    // Moves the older half of the recent points into the history. A bucket left over from the last
+    // call takes one more point if it would otherwise complete on the first one, as its two points
+    // would overwrite the unread second one:
+    void retire() {
+        int n = (xs.size() - hist) / 2;
+        int w = hist;
+        for (int i = hist; i < hist + n; i++){
+            if (pending == 0 || ys[i] <  lo_y){ lo_x = xs[i]; lo_y = ys[i]; }
+            if (pending == 0 || ys[i] >= hi_y){ hi_x = xs[i]; hi_y = ys[i]; }
+            if (++pending >= 2 * stride && i > hist){
+                if (lo_x < hi_x) emit(w, lo_x, lo_y, hi_x, hi_y);
+                else             emit(w, hi_x, hi_y, lo_x, lo_y);
+                pending = 0; }
+        }
+        slide(hist + n, w, xs.size() - hist - n);
+        xs.shrink(hist + n - w);
+        ys.shrink(hist + n - w);
+        hist = w;
+
+        if (hist >= cap / 2) halveHistory(); }
+
+    void halveHistory() {
+        int w = 0, i = 0;
+        for (; i + 4 <= hist; i += 4){
+            int lo = i, hi = i;
+            for (int j = i + 1; j < i + 4; j++){
+                if (ys[j] <  ys[lo]) lo = j;
+                if (ys[j] >= ys[hi]) hi = j; }
+            if (lo < hi) emit(w, xs[lo], ys[lo], xs[hi], ys[hi]);
+            else         emit(w, xs[hi], ys[hi], xs[lo], ys[lo]);
+        }
+        slide(i, w, xs.size() - i);         // (leftover history points are kept as they are)
+        xs.shrink(i - w);
+        ys.shrink(i - w);
+        hist  -= i - w;
+        stride *= 2; }
+
+public:
+    explicit BoundedSeries(int capacity = 4096)
+        : cap(capacity < 16 ? 16 : capacity), hist(0), stride(1), min_y(0), max_y(0), pending(0), lo_x(0), lo_y(0), hi_x(0), hi_y(0) {}
+
+    void push(double x, double y) {
+        assert(xs.size() == 0 || x >= xs.last());
+        if (xs.size() == 0 && xs.capacity() == 0){  // Allocated on first use, so unused series cost nothing.
+            xs.capacity(cap);
+            ys.capacity(cap); }
+        else if (xs.size() - hist >= cap / 2) retire();
+        if (xs.size() == 0 || y < min_y) min_y = y;
+        if (xs.size() == 0 || y > max_y) max_y = y;
+        xs.push_(x);
+        ys.push_(y); }
+
+    int                size    () const { return xs.size(); }
+    int                capacity() const { return cap; }
+    const vec<double>& times   () const { return xs; }
+    const vec<double>& values  () const { return ys; }
+    double             minValue() const { assert(size() > 0); return min_y; }
+    double             maxValue() const { assert(size() > 0); return max_y; }
+
+    // Number of points that fit in a budget of 'bytes':
+    static int capacityFor(uint64_t bytes) {
+        uint64_t n = bytes / (2 * sizeof(double));
+        return n > INT32_MAX / 2 ? INT32_MAX / 2 : (int)n; }
+};
+
+//=================================================================================================
+}
+
+#endif
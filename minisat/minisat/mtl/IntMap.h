@@ -48,6 +48,7 @@ namespace Minisat {
         void     reserve(K key)              { map.growTo(index(key)+1); }
         void     insert (K key, V val, V pad){ reserve(key, pad); operator[](key) = val; }
         void     insert (K key, V val)       { reserve(key); operator[](key) = val; }
+        void     capacity(K key)             { map.capacity(index(key)+1); }   // Room for keys up to 'key'; no new entries.
 
         void     clear  (bool dispose = false) { map.clear(dispose); }
         void     moveTo (IntMap& to)           { map.moveTo(to.map); to.index = index; }
@@ -0,0 +1,93 @@
+/*********************************************************************************[LockFreeQueue.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_LockFreeQueue_h
+#define Minisat_LockFreeQueue_h
+
+#include <atomic>
+
+#include "minisat/mtl/IntTypes.h"
+#include "minisat/mtl/XAlloc.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Bounded single-producer/single-consumer ring buffer:
+//
+// NOTE! Exactly one thread may call 'push()' and exactly one (other) thread may call 'pop()'. The
+// element type must be trivially copyable. A full queue never blocks the producer: 'push()' fails
+// and the element is counted as dropped, so a slow consumer can never stall the solver.
+
+template<class T>
+class LockFreeQueue {
+    enum { Cache_Line = 64 };
+
+    T*        buf;
+    uint32_t  mask;
+
+    alignas(Cache_Line) std::atomic<uint32_t> head;     // Next slot to read; written by the consumer.
+    uint32_t                                  tail_c;   // Consumer's cached copy of 'tail'.
+
+    alignas(Cache_Line) std::atomic<uint32_t> tail;     // Next slot to write; written by the producer.
+    uint32_t                                  head_c;   // Producer's cached copy of 'head'.
+    std::atomic<uint64_t>                     dropped_;
+
+    // Don't allow copying:
+    LockFreeQueue(const LockFreeQueue&);
+    LockFreeQueue& operator=(const LockFreeQueue&);
+
+public:
+    // Capacity is rounded up to the next power of two:
+    explicit LockFreeQueue(uint32_t min_cap = 1024) : buf(NULL), mask(0), head(0), tail_c(0), tail(0), head_c(0), dropped_(0) {
+        uint32_t cap = 2;
+        while (cap < min_cap) cap <<= 1;
+        buf  = (T*)xrealloc(NULL, sizeof(T) * cap);
+        mask = cap - 1; }
+   ~LockFreeQueue() { free(buf); }
+
+    // Producer side:
+    bool push(const T& elem) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_c > mask){
+            head_c = head.load(std::memory_order_acquire);
+            if (t - head_c > mask){
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false; } }
+        buf[t & mask] = elem;
+        tail.store(t + 1, std::memory_order_release);
+        return true; }
+
+    // Consumer side:
+    bool pop(T& elem) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_c){
+            tail_c = tail.load(std::memory_order_acquire);
+            if (h == tail_c) return false; }
+        elem = buf[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true; }
+
+    // May be called from either side (the result is only a hint for the other one):
+    uint32_t size    () const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    uint32_t capacity() const { return mask + 1; }
+    uint64_t dropped () const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+//=================================================================================================
+}
+
+#endif
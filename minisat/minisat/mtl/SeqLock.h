@@ -0,0 +1,84 @@
+/***************************************************************************************[SeqLock.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_SeqLock_h
+#define Minisat_SeqLock_h
+
+#include <atomic>
+#include <string.h>
+#include <sched.h>
+
+#include "minisat/mtl/IntTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Single-writer sequence lock around a small, trivially copyable value:
+//
+// The writer never waits. Readers copy the value and retry if a write was in progress or happened
+// meanwhile, so they always observe a complete (untorn) value. The payload is stored as relaxed
+// atomic words, which keeps concurrent reads well-defined.
+
+template<class T>
+class SeqLock {
+    enum { Words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t) };
+
+    std::atomic<uint32_t> seq;
+    std::atomic<uint64_t> data[Words];
+
+    // Don't allow copying:
+    SeqLock(const SeqLock&);
+    SeqLock& operator=(const SeqLock&);
+
+public:
+    SeqLock() : seq(0) { for (int i = 0; i < Words; i++) data[i].store(0, std::memory_order_relaxed); }
+
+    // Writer side (one thread only):
+    void write(const T& val) {
+        uint64_t tmp[Words] = {};
+        memcpy(tmp, &val, sizeof(T));
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < Words; i++)
+            data[i].store(tmp[i], std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release); }
+
+    // Reader side (any number of threads). Returns FALSE if the value was being written:
+    bool tryRead(T& out) const {
+        uint32_t s0 = seq.load(std::memory_order_acquire);
+        if (s0 & 1) return false;
+        uint64_t tmp[Words];
+        for (int i = 0; i < Words; i++)
+            tmp[i] = data[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) != s0) return false;
+        memcpy(&out, tmp, sizeof(T));
+        return true; }
+
+    void read(T& out) const {
+        for (int spins = 0; !tryRead(out); spins++)
+            if (spins >= 64) sched_yield(); }
+
+    // Number of completed writes (can be used to detect whether anything changed):
+    uint32_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -20,6 +20,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "minisat/mtl/Sort.h"
 #include "minisat/simp/SimpSolver.h"
+#include "minisat/core/Checkpoint.h"
 #include "minisat/utils/System.h"
 
 using namespace Minisat;
@@ -90,6 +91,20 @@ Var SimpSolver::newVar(lbool upol, bool dvar) {
     return v; }
 
 
+void SimpSolver::reserveVars(int n) {
+    if (n <= nVars()) return;
+    Solver::reserveVars(n);
+    Var v = n - 1;
+    frozen    .capacity(v);
+    eliminated.capacity(v);
+    if (use_simplification){
+        n_occ     .capacity(mkLit(v, true));
+        occurs    .capacity(v);
+        touched   .capacity(v);
+    }
+}
+
+
 void SimpSolver::releaseVar(Lit l){
     assert(!isEliminated(var(l)));
     if (!use_simplification && var(l) >= max_simp_var) Solver::releaseVar(l);
@@ -173,6 +188,24 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
 }
 
 
+// Every clause also has to go into the occurrence lists, so the batch is only handed on as a whole
+// when simplification is off:
+bool SimpSolver::addClauses(vec<Lit>& lits, const vec<int>& offsets)
+{
+    if (!use_simplification && !use_rcheck)
+        return Solver::addClauses(lits, offsets);
+
+    for (int i = 0; i + 1 < offsets.size(); i++){
+        add_tmp.clear();
+        for (int k = offsets[i]; k < offsets[i+1]; k++)
+            add_tmp.push(lits[k]);
+        if (!addClause_(add_tmp))
+            return false;
+    }
+    return true;
+}
+
+
 void SimpSolver::removeClause(CRef cr)
 {
     const Clause& c = ca[cr];
@@ -526,6 +559,8 @@ bool SimpSolver::eliminateVar(Var v)
     // Free watchers lists for this variable, if possible:
     if (watches[ mkLit(v)].size() == 0) watches[ mkLit(v)].clear(true);
     if (watches[~mkLit(v)].size() == 0) watches[~mkLit(v)].clear(true);
+    if (watches_bin[ mkLit(v)].size() == 0) watches_bin[ mkLit(v)].clear(true);
+    if (watches_bin[~mkLit(v)].size() == 0) watches_bin[~mkLit(v)].clear(true);
 
     return backwardSubsumptionCheck();
 }
@@ -711,3 +746,69 @@ void SimpSolver::garbageCollect()
                ca.size()*ClauseAllocator::Unit_Size, to.size()*ClauseAllocator::Unit_Size);
     to.moveTo(ca);
 }
+
+
+//=================================================================================================
+// Checkpoints:
+//
+// The occurrence lists and the elimination heap are not saved, so a checkpoint can only be taken
+// once simplification has been turned off (see 'eliminate()').
+
+
+bool SimpSolver::saveState(CheckpointWriter& out)
+{
+    if (use_simplification || !Solver::saveState(out)) return false;
+
+    out.putTag("simp");
+    out.putMap(frozen);
+    out.putVec(frozen_vars);
+    out.putMap(eliminated);
+    out.putVec(elimclauses);
+    out.put(max_simp_var);
+    out.put(elimorder);
+    out.put(bwdsub_tmpunit);
+    out.put(merges);
+    out.put(asymm_lits);
+    out.put(eliminated_vars);
+    return out.okay();
+}
+
+
+bool SimpSolver::loadState(CheckpointReader& in)
+{
+    // Turn simplification off first, so none of its state is built up for the restored variables:
+    touched  .clear(true);
+    occurs   .clear(true);
+    n_occ    .clear(true);
+    elim_heap.clear(true);
+    subsumption_queue.clear(true);
+    use_simplification = false;
+    if (!Solver::loadState(in)) return false;
+
+    if (nVars() > 0){
+        frozen    .reserve(nVars() - 1, (char)false);
+        eliminated.reserve(nVars() - 1, (char)false); }
+    in.getTag("simp");
+    in.getMap(frozen);
+    in.getVec(frozen_vars);
+    in.getMap(eliminated);
+    in.getVec(elimclauses);
+    in.get(max_simp_var);
+    in.get(elimorder);
+    in.get(bwdsub_tmpunit);
+    in.get(merges);
+    in.get(asymm_lits);
+    in.get(eliminated_vars);
+    if (!in.okay()) return false;
+
+    // Range checks, as in 'Solver::validState()'. Eliminated clauses are stored back to front,
+    // each as its literals followed by their number (see 'extendModel()'):
+    for (int i = 0; i < frozen_vars.size(); i++)
+        if (frozen_vars[i] < 0 || frozen_vars[i] >= nVars()) return false;
+    for (int i = elimclauses.size()-1; i >= 0; i--){
+        uint32_t n = elimclauses[i];
+        if (n == 0 || n > (uint32_t)i) return false;
+        for (; n > 0; n--)
+            if (elimclauses[--i] >= (uint32_t)(2*nVars())) return false; }
+    return true;
+}
@@ -48,6 +48,8 @@ class SimpSolver : public Solver {
     bool    addClause (Lit p, Lit q, Lit r); // Add a ternary clause to the solver.
     bool    addClause (Lit p, Lit q, Lit r, Lit s); // Add a quaternary clause to the solver. 
     bool    addClause_(      vec<Lit>& ps);
+    bool    addClauses(      vec<Lit>& lits, const vec<int>& offsets);
+    void    reserveVars(int n);
     bool    substitute(Var v, Lit x);  // Replace all occurences of v with x (may cause a contradiction).
 
     // Variable mode:
@@ -168,6 +170,8 @@ class SimpSolver : public Solver {
     bool          strengthenClause         (CRef cr, Lit l);
     bool          implied                  (const vec<Lit>& c);
     void          relocAll                 (ClauseAllocator& to);
+    bool          saveState                (CheckpointWriter& out); // Only once simplification is turned off.
+    bool          loadState                (CheckpointReader& in);
 };
 
 
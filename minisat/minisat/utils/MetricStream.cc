@@ -0,0 +1,201 @@
+/*********************************************************************************[MetricStream.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "minisat/mtl/XAlloc.h"
+#include "minisat/utils/MetricStream.h"
+
+using namespace Minisat;
+
+static const char     stream_magic[8] = "MSVIZMS";
+static const uint32_t stream_version  = 1;
+static const uint64_t initial_records = 1 << 16;
+
+//=================================================================================================
+// Writer:
+
+
+bool MetricStream::open(const char* path)
+{
+    close();
+    fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return false;
+
+    if (!map(initial_records)){
+        ::close(fd);
+        fd = -1;
+        return false; }
+
+    memcpy(hdr->magic, stream_magic, sizeof(stream_magic));
+    hdr->version     = stream_version;
+    hdr->record_size = sizeof(MetricRecord);
+    hdr->count       = 0;
+    hdr->closed      = 0;
+    n                = 0;
+    return true;
+}
+
+
+bool MetricStream::map(uint64_t new_cap)
+{
+    size_t bytes = sizeof(MetricStreamHeader) + new_cap * sizeof(MetricRecord);
+    if (ftruncate(fd, bytes) != 0) return false;
+
+    void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) return false;
+
+    if (hdr != NULL) munmap(hdr, sizeof(MetricStreamHeader) + cap * sizeof(MetricRecord));
+    hdr  = (MetricStreamHeader*)mem;
+    recs = (MetricRecord*)(hdr + 1);
+    cap  = new_cap;
+    return true;
+}
+
+
+void MetricStream::append(uint32_t solver, uint32_t metric, double time, double value)
+{
+    assert(isOpen());
+    if (n == cap && !map(cap * 2))
+        throw OutOfMemoryException();
+
+    MetricRecord& r = recs[n++];
+    r.solver = solver;
+    r.metric = metric;
+    r.time   = time;
+    r.value  = value;
+}
+
+
+void MetricStream::appendLabel(uint32_t solver, const char* name)
+{
+    size_t len = strlen(name);
+    for (size_t i = 0; i < len; i += 16){
+        char piece[16] = { 0 };
+        memcpy(piece, name + i, len - i < 16 ? len - i : 16);
+        append(solver, metric_label, 0, 0);
+        memcpy(&recs[n-1].time,  piece,     8);
+        memcpy(&recs[n-1].value, piece + 8, 8);
+    }
+}
+
+
+void MetricStream::flush()
+{
+    if (hdr != NULL)
+        __atomic_store_n(&hdr->count, n, __ATOMIC_RELEASE);
+}
+
+
+void MetricStream::close()
+{
+    if (fd == -1) return;
+
+    flush();
+    __atomic_store_n(&hdr->closed, 1, __ATOMIC_RELEASE);
+    munmap(hdr, sizeof(MetricStreamHeader) + cap * sizeof(MetricRecord));
+    if (ftruncate(fd, sizeof(MetricStreamHeader) + n * sizeof(MetricRecord)) != 0) {}
+    ::close(fd);
+
+    fd   = -1;
+    hdr  = NULL;
+    recs = NULL;
+    cap  = 0;
+}
+
+
+//=================================================================================================
+// Reader:
+
+
+bool MetricStreamReader::open(const char* path)
+{
+    close();
+    fd = ::open(path, O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(MetricStreamHeader)) goto fail;
+
+    {   void* mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mem == MAP_FAILED) goto fail;
+        hdr    = (const MetricStreamHeader*)mem;
+        recs   = (const MetricRecord*)(hdr + 1);
+        mapped = st.st_size;
+    }
+
+    if (memcmp(hdr->magic, stream_magic, sizeof(stream_magic)) != 0
+     || hdr->version != stream_version
+     || hdr->record_size != sizeof(MetricRecord)){
+        close();
+        return false; }
+
+    return true;
+
+fail:
+    ::close(fd);
+    fd = -1;
+    return false;
+}
+
+
+uint64_t MetricStreamReader::refresh()
+{
+    assert(fd != -1);
+    uint64_t count  = __atomic_load_n(&hdr->count, __ATOMIC_ACQUIRE);
+    uint64_t needed = sizeof(MetricStreamHeader) + count * sizeof(MetricRecord);
+
+    if (needed > mapped){
+        // The writer grew the file; map all of it again:
+        struct stat st;
+        void*       mem;
+        if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= needed
+         && (mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) != MAP_FAILED){
+            munmap((void*)hdr, mapped);
+            hdr    = (const MetricStreamHeader*)mem;
+            recs   = (const MetricRecord*)(hdr + 1);
+            mapped = st.st_size;
+        }
+    }
+
+    // Never hand out records beyond the current mapping (e.g. if re-mapping failed above):
+    uint64_t avail = (mapped - sizeof(MetricStreamHeader)) / sizeof(MetricRecord);
+    return count < avail ? count : avail;
+}
+
+
+bool MetricStreamReader::closed() const
+{
+    return __atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE) != 0;
+}
+
+
+void MetricStreamReader::close()
+{
+    if (fd == -1) return;
+    munmap((void*)hdr, mapped);
+    ::close(fd);
+    fd     = -1;
+    hdr    = NULL;
+    recs   = NULL;
+    mapped = 0;
+}
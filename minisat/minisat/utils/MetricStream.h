@@ -0,0 +1,119 @@
+/**********************************************************************************[MetricStream.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_MetricStream_h
+#define Minisat_MetricStream_h
+
+#include <stddef.h>
+#include <string.h>
+
+#include "minisat/mtl/IntTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Append-only binary metric stream:
+//
+// A memory-mapped file consisting of a fixed header followed by fixed-width records. The writer
+// fills in records first and then publishes them by advancing 'count' (release store), so a reader
+// mapping the same file, possibly while it is still being written, never sees a partial record.
+// The file is grown in chunks and truncated to its used size on 'close()'.
+//
+// A solver can be given a name with label records ('metric == metric_label'). Each holds the next
+// 16 bytes of the name in place of 'time' and 'value', padded with NUL, so readers that don't know
+// them skip them like any unknown metric.
+
+enum { metric_label = 0xFFFFFFFFu };
+
+struct MetricRecord {
+    uint32_t solver;            // Index of the solver within the run.
+    uint32_t metric;            // Metric id (the meaning is up to the producer).
+    double   time;              // Seconds since the solver started.
+    double   value;
+
+    // The piece of the name held by a label record, as a C string ('buf' needs 17 bytes):
+    void labelText(char* buf) const {
+        memcpy(buf, &time, 8); memcpy(buf + 8, &value, 8); buf[16] = 0; }
+};
+
+struct MetricStreamHeader {
+    char     magic[8];          // "MSVIZMS\0"
+    uint32_t version;
+    uint32_t record_size;       // sizeof(MetricRecord)
+    uint64_t count;             // Number of published records.
+    uint32_t closed;            // Set when the writer is done; readers in live mode may stop then.
+    uint32_t pad[9];
+};
+
+class MetricStream {
+    int                 fd;
+    MetricStreamHeader* hdr;
+    MetricRecord*       recs;
+    uint64_t            cap;    // Number of records the current mapping can hold.
+    uint64_t            n;      // Number of records written (== hdr->count after 'flush()').
+
+    bool map(uint64_t new_cap);
+
+    // Don't allow copying:
+    MetricStream(const MetricStream&);
+    MetricStream& operator=(const MetricStream&);
+
+public:
+    MetricStream() : fd(-1), hdr(NULL), recs(NULL), cap(0), n(0) {}
+   ~MetricStream() { close(); }
+
+    bool     open  (const char* path);  // Create (or truncate) 'path'. Returns FALSE on failure.
+    void     close ();
+    bool     isOpen() const { return fd != -1; }
+
+    // Single writer only:
+    void     append(uint32_t solver, uint32_t metric, double time, double value);
+    void     appendLabel(uint32_t solver, const char* name);    // Once per solver.
+    void     flush ();                  // Make all appended records visible to readers.
+    uint64_t size  () const { return n; }
+};
+
+
+// Read side, for a stream that may still be growing:
+//
+class MetricStreamReader {
+    int                       fd;
+    const MetricStreamHeader* hdr;
+    const MetricRecord*       recs;
+    uint64_t                  mapped;   // Bytes currently mapped.
+
+    // Don't allow copying:
+    MetricStreamReader(const MetricStreamReader&);
+    MetricStreamReader& operator=(const MetricStreamReader&);
+
+public:
+    MetricStreamReader() : fd(-1), hdr(NULL), recs(NULL), mapped(0) {}
+   ~MetricStreamReader() { close(); }
+
+    bool     open   (const char* path); // Returns FALSE if the file is missing or not a metric stream.
+    void     close  ();
+
+    uint64_t refresh();                 // Re-map if the file grew; returns the number of published records.
+    bool     closed () const;           // TRUE if the writer has finished the stream.
+
+    const MetricRecord& operator[](uint64_t i) const { return recs[i]; } // Valid for 'i < refresh()'.
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,189 @@
+/********************************************************************************[MetricsServer.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <chrono>
+
+#include "minisat/utils/System.h"
+#include "minisat/utils/MetricsServer.h"
+
+using namespace Minisat;
+
+static const int    max_request    = 4096;  // Longer request heads are cut off (only the first line matters).
+static const double io_timeout     = 1.0;   // Seconds a slow client may stall the owner's loop.
+static const char   content_type[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+//=================================================================================================
+// Setup:
+
+
+static bool startListening(int fd, const sockaddr* addr, socklen_t len)
+{
+    return bind(fd, addr, len) == 0
+        && listen(fd, 16) == 0
+        && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+
+bool MetricsServer::listenTcp(int port)
+{
+    close();
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) return false;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (!startListening(fd, (sockaddr*)&addr, sizeof(addr))){
+        close();
+        return false; }
+    return true;
+}
+
+
+bool MetricsServer::listenUnix(const char* path)
+{
+    close();
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strlen(path) >= sizeof(addr.sun_path)) return false;
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return false;
+
+    // Only a socket may be replaced; anything else at 'path' makes 'bind()' fail:
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+    if (!startListening(fd, (sockaddr*)&addr, sizeof(addr))){
+        close();
+        return false; }
+    unix_path = path;
+    return true;
+}
+
+
+void MetricsServer::close()
+{
+    if (fd == -1) return;
+    ::close(fd);
+    fd = -1;
+    if (!unix_path.empty()){
+        unlink(unix_path.c_str());
+        unix_path.clear(); }
+}
+
+
+//=================================================================================================
+// Serving:
+
+
+static bool sendAll(int conn, const char* data, size_t len)
+{
+    while (len > 0){
+        ssize_t w = send(conn, data, len, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        data += w;
+        len  -= w;
+    }
+    return true;
+}
+
+
+void MetricsServer::answer(int conn, void (*body)(std::string& out))
+{
+    timeval tv;
+    tv.tv_sec  = (time_t)io_timeout;
+    tv.tv_usec = (suseconds_t)((io_timeout - tv.tv_sec) * 1e6);
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // Read the request head:
+    char req[max_request + 1];
+    int  len = 0;
+    while (len < max_request){
+        ssize_t r = recv(conn, req + len, max_request - len, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        len += r;
+        req[len] = 0;
+        if (strstr(req, "\r\n\r\n") != NULL || strstr(req, "\n\n") != NULL) break;
+    }
+    req[len] = 0;
+
+    const char* status = "200 OK";
+    std::string payload;
+    if (strncmp(req, "GET ", 4) != 0)
+        status = "405 Method Not Allowed";
+    else{
+        const char* path = req + 4;
+        size_t      plen = strcspn(path, " ?\r\n");
+        if ((plen == 8 && strncmp(path, "/metrics", 8) == 0) || (plen == 1 && path[0] == '/'))
+            body(payload);
+        else
+            status = "404 Not Found";
+    }
+
+    char head[256];
+    int  hlen = snprintf(head, sizeof(head), "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                         status, content_type, payload.size());
+    if (sendAll(conn, head, hlen))
+        sendAll(conn, payload.data(), payload.size());
+}
+
+
+void MetricsServer::serve(double timeout, void (*body)(std::string& out))
+{
+    if (fd == -1) return;
+    double deadline = realTime() + timeout;
+    for (;;){
+        double left = deadline - realTime();
+        if (left <= 0) return;
+
+        pollfd p;
+        p.fd     = fd;
+        p.events = POLLIN;
+        int r = poll(&p, 1, (int)(left * 1000) + 1);
+        if (r < 0 && errno != EINTR){                // (still honour the timeout, the owner relies on it)
+            std::this_thread::sleep_for(std::chrono::duration<double>(left));
+            return; }
+        if (r <= 0) continue;
+
+        int conn = accept(fd, NULL, NULL);
+        if (conn == -1) continue;
+        answer(conn, body);
+        ::close(conn);
+    }
+}
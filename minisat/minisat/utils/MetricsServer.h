@@ -0,0 +1,59 @@
+/*********************************************************************************[MetricsServer.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_MetricsServer_h
+#define Minisat_MetricsServer_h
+
+#include <string>
+
+namespace Minisat {
+
+//=================================================================================================
+// Minimal scrape endpoint for OpenMetrics (Prometheus) text:
+//
+// Listens on a localhost TCP port or a Unix domain socket and answers every 'GET /metrics' (or
+// 'GET /') with the text produced by a callback, one connection at a time. There is no thread of
+// its own: the owner calls 'serve()' from its polling loop instead of sleeping, so the callback
+// always runs on the owner's thread.
+
+class MetricsServer {
+    int         fd;
+    std::string unix_path;      // Removed again on 'close()'.
+
+    void answer(int conn, void (*body)(std::string& out));
+
+    // Don't allow copying:
+    MetricsServer(const MetricsServer&);
+    MetricsServer& operator=(const MetricsServer&);
+
+public:
+    MetricsServer() : fd(-1) {}
+   ~MetricsServer() { close(); }
+
+    bool listenTcp (int port);          // Bound to 127.0.0.1 only. Returns FALSE on failure.
+    bool listenUnix(const char* path);  // Replaces a stale socket (no other file) at 'path'. Returns FALSE on failure.
+    void close     ();
+    bool isOpen    () const { return fd != -1; }
+
+    // Answers requests for up to 'timeout' seconds (returns early only if not open):
+    void serve     (double timeout, void (*body)(std::string& out));
+};
+
+//=================================================================================================
+}
+
+#endif
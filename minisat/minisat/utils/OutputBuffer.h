@@ -0,0 +1,113 @@
+/**********************************************************************************[OutputBuffer.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_OutputBuffer_h
+#define Minisat_OutputBuffer_h
+
+#include <stdio.h>
+#include <string.h>
+
+#include "minisat/mtl/IntTypes.h"
+#include "minisat/mtl/XAlloc.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Buffered text output:
+//
+// The writing counterpart of 'StreamBuffer': output is collected in a large block that goes to
+// 'fwrite()' in one piece, and integers are formatted here, two digits at a time, rather than by
+// 'fprintf()'. Write errors are remembered and reported by 'flush()'.
+
+
+class OutputBuffer {
+    FILE* out;
+    char* buf;
+    int   pos;
+    bool  failed;
+
+    enum { buffer_size = 1 << 20 };
+
+    void reserve(int n) { if (pos + n > buffer_size) flush(); }
+
+    // Don't allow copying:
+    OutputBuffer(const OutputBuffer&);
+    OutputBuffer& operator=(const OutputBuffer&);
+
+public:
+    explicit OutputBuffer(FILE* f) : out(f), buf((char*)xrealloc(NULL, buffer_size)), pos(0), failed(false) {}
+    ~OutputBuffer() { flush(); free(buf); }
+
+    // Writes out everything buffered so far. Returns FALSE if any write has failed:
+    bool flush() {
+        if (pos > 0 && !failed && fwrite(buf, 1, pos, out) != (size_t)pos) failed = true;
+        pos = 0;
+        return !failed; }
+
+    void put(char c) { reserve(1); buf[pos++] = c; }
+
+    void put(const char* s) {
+        size_t n = strlen(s);
+        if (n > buffer_size / 2){
+            flush();
+            if (!failed && fwrite(s, 1, n, out) != n) failed = true;
+        }else{
+            reserve((int)n);
+            memcpy(buf + pos, s, n);
+            pos += (int)n; } }
+
+    void putUInt(uint64_t x) {
+        static const char digit_pairs[201] =
+            "0001020304050607080910111213141516171819"
+            "2021222324252627282930313233343536373839"
+            "4041424344454647484950515253545556575859"
+            "6061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        char  tmp[20];
+        char* p = tmp + sizeof(tmp);
+        while (x >= 100){
+            p -= 2;
+            memcpy(p, digit_pairs + 2 * (x % 100), 2);
+            x /= 100; }
+        if (x >= 10){
+            p -= 2;
+            memcpy(p, digit_pairs + 2 * x, 2);
+        }else
+            *--p = (char)('0' + x);
+
+        int n = (int)(tmp + sizeof(tmp) - p);
+        reserve(n);
+        memcpy(buf + pos, p, n);
+        pos += n; }
+
+    void putInt(int64_t x) {
+        if (x < 0){
+            put('-');
+            putUInt(0 - (uint64_t)x);
+        }else
+            putUInt((uint64_t)x); }
+
+    // Floating point numbers are rare in the output, so they just go through 'snprintf()':
+    void putDouble(double x) {
+        reserve(32);
+        pos += snprintf(buf + pos, 32, "%g", x); }
+};
+
+//=================================================================================================
+}
+
+#endif
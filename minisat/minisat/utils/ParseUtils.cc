@@ -0,0 +1,135 @@
+/***********************************************************************************[ParseUtils.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "minisat/utils/ParseUtils.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+// StreamBuffer:
+
+
+StreamBuffer::StreamBuffer(gzFile i) : in(i), buf(NULL), pos(0), size(0), head(0), tail(0), done(false), stop(false)
+{
+    for (int k = 0; k < buffers; k++)
+        blocks[k] = (unsigned char*)xrealloc(NULL, buffer_size);
+    gzbuffer(in, buffer_size);      // (before the first read, or it has no effect)
+    reader = std::thread(&StreamBuffer::readAhead, this);
+    assureLookahead();
+}
+
+
+StreamBuffer::~StreamBuffer()
+{
+    {   std::lock_guard<std::mutex> guard(lock);
+        stop = true; }
+    cond.notify_all();
+    reader.join();
+    for (int k = 0; k < buffers; k++)
+        free(blocks[k]);
+}
+
+
+// Reader thread: fills free blocks in order until end of file.
+void StreamBuffer::readAhead()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;){
+        while (!stop && head - tail == buffers)
+            cond.wait(guard);
+        if (stop) return;
+
+        int k = (int)(head % buffers);
+        guard.unlock();
+        int r = gzread(in, blocks[k], buffer_size);
+        guard.lock();
+
+        if (r <= 0) done = true;
+        else{
+            sizes[k] = r;
+            head++; }
+        cond.notify_all();
+        if (done) return;
+    }
+}
+
+
+// Gives the current block back to the reader and waits for the next one. At end of file 'size'
+// stays 0, so that 'operator*' returns EOF from then on.
+void StreamBuffer::nextBlock()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    if (buf != NULL){
+        tail++;
+        buf = NULL;
+        cond.notify_all(); }
+
+    while (head == tail && !done)
+        cond.wait(guard);
+
+    pos  = 0;
+    size = 0;
+    if (head > tail){
+        int k = (int)(tail % buffers);
+        buf  = blocks[k];
+        size = sizes[k]; }
+}
+
+
+//=================================================================================================
+// MappedBuffer:
+
+
+bool MappedBuffer::open(const char* path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat st;
+    unsigned char magic[2];
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 2
+     || pread(fd, magic, 2, 0) != 2 || (magic[0] == 0x1f && magic[1] == 0x8b)){   // gzip
+        ::close(fd);
+        return false; }
+
+    void* mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                // (the mapping stays valid)
+    if (mem == MAP_FAILED) return false;
+    madvise(mem, st.st_size, MADV_SEQUENTIAL);
+
+    len   = st.st_size;
+    owner = true;
+    beg = cur = (const unsigned char*)mem;
+    end = beg + len;
+    return true;
+}
+
+
+void MappedBuffer::close()
+{
+    if (beg == NULL) return;
+    if (owner) munmap((void*)beg, len);
+    beg = end = cur = NULL;
+    len   = 0;
+    owner = false;
+}
@@ -23,37 +23,58 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <zlib.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "minisat/mtl/IntTypes.h"
 #include "minisat/mtl/XAlloc.h"
 
 namespace Minisat {
 
 //-------------------------------------------------------------------------------------------------
 // A simple buffered character stream class:
-
+//
+// Decompression is pipelined: a reader thread keeps up to 'buffers' blocks ahead of the parser
+// with 'gzread()', so inflating and parsing overlap instead of taking turns. The parser only
+// synchronizes with it once per block.
 
 
 class StreamBuffer {
     gzFile         in;
-    unsigned char* buf;
+    unsigned char* buf;             // Block being parsed (or NULL).
     int            pos;
     int            size;
 
-    enum { buffer_size = 64*1024 };
+    enum { buffer_size = 256*1024, buffers = 3 };
+
+    unsigned char*          blocks[buffers];
+    int                     sizes [buffers];
+    uint64_t                head;   // Blocks filled by the reader so far.
+    uint64_t                tail;   // Blocks given back by the parser so far.
+    bool                    done;   // The reader hit end of file (or an error).
+    bool                    stop;   // The parser is done; the reader should exit.
+    std::mutex              lock;
+    std::condition_variable cond;
+    std::thread             reader;
+
+    void readAhead();
+    void nextBlock();
 
     void assureLookahead() {
-        if (pos >= size) {
-            pos  = 0;
-            size = gzread(in, buf, buffer_size); } }
+        if (pos >= size) nextBlock(); }
+
+    // Don't allow copying:
+    StreamBuffer(const StreamBuffer&);
+    StreamBuffer& operator=(const StreamBuffer&);
 
 public:
-    explicit StreamBuffer(gzFile i) : in(i), pos(0), size(0){
-        buf = (unsigned char*)xrealloc(NULL, buffer_size);
-        assureLookahead();
-    }
-    ~StreamBuffer() { free(buf); }
+    explicit StreamBuffer(gzFile i);
+    ~StreamBuffer();
 
     int  operator *  () const { return (pos >= size) ? EOF : buf[pos]; }
     void operator ++ ()       { pos++; assureLookahead(); }
@@ -61,11 +82,51 @@ public:
 };
 
 
+//-------------------------------------------------------------------------------------------------
+// A memory-mapped, uncompressed input file:
+//
+// Same interface as 'StreamBuffer', without refills or per-character bounds checks beyond a single
+// pointer comparison. Also used by the overloads of 'parseInt()' etc. below, which scan several
+// bytes at a time.
+
+
+class MappedBuffer {
+    const unsigned char* beg;
+    const unsigned char* end;
+    size_t               len;
+    bool                 owner;     // FALSE for a view of (part of) another buffer's mapping.
+
+    // Don't allow copying:
+    MappedBuffer(const MappedBuffer&);
+    MappedBuffer& operator=(const MappedBuffer&);
+
+public:
+    const unsigned char* cur;
+
+    MappedBuffer() : beg(NULL), end(NULL), len(0), owner(false), cur(NULL) {}
+    // Non-owning view of the bytes [b, e) of another buffer:
+    MappedBuffer(const unsigned char* b, const unsigned char* e) : beg(b), end(e), len(e - b), owner(false), cur(b) {}
+    ~MappedBuffer() { close(); }
+
+    // Maps 'path' if it is a regular, non-empty file that is not gzip-compressed. Returns FALSE
+    // otherwise (then the caller should fall back to 'StreamBuffer'):
+    bool   open  (const char* path);
+    void   close ();
+    bool   isOpen() const { return beg != NULL; }
+
+    int    operator *  () const { return cur < end ? *cur : EOF; }
+    void   operator ++ ()       { cur++; }
+    size_t position    () const { return cur - beg; }
+    size_t remaining   () const { return cur < end ? end - cur : 0; }
+};
+
+
 //-------------------------------------------------------------------------------------------------
 // End-of-file detection functions for StreamBuffer and char*:
 
 
 static inline bool isEof(StreamBuffer& in) { return *in == EOF;  }
+static inline bool isEof(MappedBuffer& in) { return in.remaining() == 0; }
 static inline bool isEof(const char*   in) { return *in == '\0'; }
 
 //-------------------------------------------------------------------------------------------------
@@ -100,6 +161,66 @@ static int parseInt(B& in) {
     return neg ? -val : val; }
 
 
+//-------------------------------------------------------------------------------------------------
+// Faster versions for 'MappedBuffer':
+
+
+static inline void skipWhitespace(MappedBuffer& in) {
+    const unsigned char* p   = in.cur;
+    const unsigned char* end = p + in.remaining();
+    while (p < end && ((*p >= 9 && *p <= 13) || *p == 32))
+        p++;
+    in.cur = p; }
+
+
+static inline void skipLine(MappedBuffer& in) {
+    const void* nl = memchr(in.cur, '\n', in.remaining());
+    in.cur = nl == NULL ? in.cur + in.remaining() : (const unsigned char*)nl + 1; }
+
+
+// Value of the 'n' (1..8) leading decimal digits of the little-endian word 'w' (SWAR):
+static inline uint32_t swarDigits(uint64_t w, int n) {
+    w <<= 8 * (8 - n);                                                  // Missing digits become leading zeros.
+    w   = (w & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;                      // Pairs:   10 * hi + lo.
+    w   = (w & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;                  // Quads:  100 * hi + lo.
+    return (uint32_t)((w & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32); } // 10000 * hi + lo.
+
+
+// Number of leading bytes of 'w' that are decimal digits (0..8):
+static inline int swarDigitCount(uint64_t w) {
+    const uint64_t hi  = 0x8080808080808080ULL;
+    uint64_t       lo7 = w & ~hi;
+    uint64_t       bad = ((lo7 + 0x4646464646464646ULL) | ~(lo7 + 0x5050505050505050ULL) | w) & hi;  // > '9', < '0', or >= 0x80.
+    return bad == 0 ? 8 : __builtin_ctzll(bad) >> 3; }
+
+
+// Scans the integer at 'p' up to eight digits at a time. There must be at least nine bytes before
+// 'end'. Shared by 'parseInt()' below and the clause reader of 'Dimacs.h', which keeps its position
+// in a local pointer:
+static inline int parseIntSwar(const unsigned char*& p, const unsigned char* end) {
+    bool neg = *p == '-';
+    if (neg || *p == '+') p++;
+
+    uint64_t w;
+    memcpy(&w, p, 8);
+    int n = swarDigitCount(w);
+    if (n == 0) fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *p), exit(3);
+    int val = (int)swarDigits(w, n);
+    p += n;
+    if (n == 8)
+        while (p < end && *p >= '0' && *p <= '9')
+            val = val*10 + (*p++ - '0');
+
+    return neg ? -val : val; }
+
+
+// Falls back to the generic version near the end of the file:
+static inline int parseInt(MappedBuffer& in) {
+    skipWhitespace(in);
+    if (in.remaining() < 9) return parseInt<MappedBuffer>(in);
+    return parseIntSwar(in.cur, in.cur + in.remaining()); }
+
+
 // String matching: in case of a match the input iterator will be advanced the corresponding
 // number of characters.
 template<class B>
@@ -21,6 +21,11 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <signal.h>
 #include <stdio.h>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "minisat/utils/System.h"
 
 #if defined(__linux__)
@@ -167,3 +172,29 @@ void Minisat::sigTerm(void handler(int))
     signal(SIGXCPU,handler);
 #endif
 }
+
+
+void Minisat::sigCheckpoint(void handler(int))
+{
+#ifdef SIGUSR1
+    signal(SIGUSR1, handler);
+#else
+    (void)handler;
+#endif
+}
+
+
+#if defined(__linux__)
+bool Minisat::pinThread(int core)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+#else
+bool Minisat::pinThread(int /*core*/)
+{
+    return false;
+}
+#endif
@@ -32,6 +32,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 namespace Minisat {
 
 static inline double cpuTime(void); // CPU-time in seconds.
+static inline double realTime(void); // Monotonic wall-clock time in seconds.
+static inline double threadCpuTime(void); // CPU-time of the calling thread in seconds.
 
 extern double memUsed();            // Memory in mega bytes (returns 0 for unsupported architectures).
 extern double memUsedPeak(bool strictlyPeak = false); // Peak-memory in mega bytes (returns 0 for unsupported architectures).
@@ -46,6 +48,11 @@ extern void   limitTime(uint32_t max_cpu_time); // Set a limit on maximum CPU ti
                                                 // semantics varies depending on architecture.
 
 extern void   sigTerm(void handler(int));      // Set up handling of available termination signals.
+extern void   sigCheckpoint(void handler(int));// Set up handling of the checkpoint request signal (SIGUSR1), if
+                                               // available.
+
+extern bool   pinThread(int core);             // Bind the calling thread to one CPU core. Returns FALSE if
+                                               // unsupported on this architecture or the call failed.
 
 }
 
@@ -56,8 +63,11 @@ extern void   sigTerm(void handler(int));      // Set up handling of available t
 #include <time.h>
 
 static inline double Minisat::cpuTime(void) { return (double)clock() / CLOCKS_PER_SEC; }
+static inline double Minisat::realTime(void) { return (double)clock() / CLOCKS_PER_SEC; }
+static inline double Minisat::threadCpuTime(void) { return (double)clock() / CLOCKS_PER_SEC; }
 
 #else
+#include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
@@ -67,6 +77,16 @@ static inline double Minisat::cpuTime(void) {
     getrusage(RUSAGE_SELF, &ru);
     return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1000000; }
 
+static inline double Minisat::realTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000; }
+
+static inline double Minisat::threadCpuTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000; }
+
 #endif
 
 #endif